@@ -0,0 +1,43 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <cstdint>
+
+#include "point.hpp"
+#include "bounds.hpp"
+#include "mesh.hpp"
+
+
+/**
+ * Decides what can be skipped when drawing through the given projection and modelview
+ * matrices (column major, as returned by glGetDoublev), with bounds in model coordinates
+ *
+ * Spheres are tested against the view frustum. Meshlets are also skipped when their
+ * normal cone shows every triangle faces away from the camera (and would thus be culled
+ * by OpenGL anyway), which is only tested when the modelview keeps angles.
+ */
+class Culler {
+
+private:
+    std::array<std::array<double, 4>, 6> planes;    //frustum planes in eye coordinates, facing inwards
+    std::array<double, 16> modelview;
+    double scale;           //largest factor by which the modelview stretches lengths
+    bool keeps_angles;      //whether the modelview is made up of rotations, uniform scales and translations
+
+    CartPoint3d to_eye(const std::array<double, 3> &p) const;
+    bool in_frustum(const CartPoint3d &center, double radius) const;
+
+public:
+    Culler(const std::array<double, 16> &projection, const std::array<double, 16> &modelview);
+
+    bool is_visible(const Bounds &bounds) const;
+    bool is_visible(const Meshlet &meshlet) const;
+
+    //first index and index count of each run of consecutive visible meshlets
+    std::vector<std::pair<uint32_t, uint32_t>> visible_ranges(const std::vector<Meshlet> &meshlets) const;
+};
+
+#endif
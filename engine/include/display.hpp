@@ -8,12 +8,17 @@
 #include <set>
 #include <array>
 #include <optional>
+#include <memory>
+#include <chrono>
 
 #include "point.hpp"
 #include "error_handler.hpp"
 #include "xml_parser.hpp"
 #include "file_handler.hpp"
+#include "loader.hpp"
+#include "mesh_cache.hpp"
 #include "vbo.hpp"
+#include "culling.hpp"
 #include "data_structures.hpp"
 #include "matrix.hpp"
 #include "interaction.hpp" //must be below vbo.hpp !!
@@ -10,9 +10,12 @@
 #include "error_handler.hpp"
 #include "point.hpp"
 #include "filters.hpp"
+#include "mesh.hpp"
+#include "text_reader.hpp"
 
 
-std::tuple<ErrorCode, std::vector<CartPoint3d>, std::vector<CartPoint3d>, std::vector<CartPoint2d>>
-files_reader(const std::string &model_fn);
+//threads bounds how many threads a text model is read on, see read_text_mesh
+std::tuple<ErrorCode, Mesh, Bounds> files_reader(const std::string &model_fn, unsigned threads = 0);
+std::tuple<ErrorCode, QuantizedMesh, Bounds> quantized_reader(const std::string &model_fn);
 
 #endif
\ No newline at end of file
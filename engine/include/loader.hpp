@@ -0,0 +1,99 @@
+#ifndef LOADER_HPP
+#define LOADER_HPP
+
+#include <set>
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "error_code.hpp"
+#include "mesh.hpp"
+#include "bounds.hpp"
+#include "mesh_cache.hpp"
+
+
+//a model read off disk, as either a mesh, a quantized mesh or a cached one, waiting to be uploaded
+struct LoadedModel {
+    ErrorCode code;
+    bool quantized;
+    Mesh mesh;
+    QuantizedMesh qmesh;
+    std::optional<CachedMesh> cached;
+    Bounds bounds;
+
+    LoadedModel();
+};
+
+//an image decoded to RGBA, bottom row first as glTexImage2D takes it, with no pixels if it couldn't be loaded
+struct LoadedImage {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+
+    LoadedImage();
+};
+
+/**
+ * Reads every model and decodes every image on a pool of threads, one per core, in the background,
+ * handing each one over as soon as it is done, so that the GL thread, which alone may upload them,
+ * can draw the scene meanwhile
+ *
+ * Models are read each on its own, as quantized meshes only if keep_quantized is set.
+ * Given a cache, text models are mapped from it when up to date, and stored in it otherwise,
+ * after which the cache is trimmed to its maximum size.
+ * DevIL keeps the image it works on as global state, so images are decoded one after
+ * another, on a single thread of the pool, alongside the models being read on the others.
+ * Cores without a worker, as there are when there are fewer tasks than cores or once workers
+ * run out of them, are lent to the models being read, so that threads never outnumber cores.
+ *
+ * Destroying the streamer stops it once the assets being loaded are done.
+ */
+class AssetStreamer {
+
+private:
+    std::vector<std::pair<std::string, LoadedModel>> models;    //never resized once the workers start
+    std::vector<std::pair<std::string, LoadedImage>> images;
+    bool keep_quantized;
+    std::optional<MeshCache> cache;
+
+    std::vector<std::function<void()>> tasks;
+    std::atomic<size_t> next_task;
+    std::atomic<size_t> finished_tasks;
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> spare_threads;
+
+    std::mutex mutex;                   //guards the ready queues
+    std::deque<size_t> ready_models;    //indexes into models, in the order they were done
+    std::deque<size_t> ready_images;
+    size_t taken;
+
+    std::vector<std::thread> pool;
+
+    void load_model(size_t m);
+    void decode_images();
+    void finish_task();
+
+public:
+    AssetStreamer(const std::set<std::string> &model_fns, const std::set<std::string> &image_fns,
+                  bool keep_quantized, std::optional<MeshCache> &&cache);
+    ~AssetStreamer();
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    //the next model or image done loading, if any, for the caller to upload
+    std::optional<std::pair<std::string, LoadedModel>> take_model();
+    std::optional<std::pair<std::string, LoadedImage>> take_image();
+
+    //assets taken so far, out of every one there is to load
+    size_t taken_count();
+    size_t total_count() const;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <optional>
+#include <filesystem>
+#include <cstdint>
+
+#include "mesh.hpp"
+#include "bounds.hpp"
+#include "mapped_file.hpp"
+
+
+//a cached mesh, mapped into memory, whose attributes are ready to be handed to glBufferData
+struct CachedMesh {
+    std::unique_ptr<MappedFile> file;
+
+    const float *vertexes;          //x, y and z of each vertex
+    const float *normals;
+    const float *text_coords;       //s and t of each vertex
+    const uint32_t *indexes;
+    size_t vertex_count;
+    size_t index_count;
+
+    std::vector<Meshlet> meshlets;
+    Bounds bounds;
+
+    CachedMesh();
+};
+
+/**
+ * Keeps text meshes (.3d, .norm and .text triplets, plus .bounds) converted to single blobs,
+ * one per mesh path, of single precision attributes laid out as they are uploaded,
+ * so that later runs map them instead of parsing the text again
+ *
+ * An entry is up to date while the size and modification time of each of its source files
+ * are unchanged, or failing that, while the hash of their contents is, in which case its times
+ * are brought up to date. Only meshes with normals and texture coordinates are cached.
+ *
+ * Entries are timestamped whenever they are used, so that, once the cache grows past
+ * its maximum size, evict removes the least recently used ones first.
+ */
+class MeshCache {
+
+private:
+    std::filesystem::path directory;
+    uint64_t max_size;
+
+    std::filesystem::path entry_path(const std::string &model_fn) const;
+
+public:
+    static constexpr uint64_t DEFAULT_MAX_SIZE { uint64_t{ 1 } << 30 };
+
+    /**
+     * $XDG_CACHE_HOME/cg-engine, falling back to ~/.cache/cg-engine,
+     * then on Windows to %LOCALAPPDATA%\cg-engine, and then to .cg-engine-cache
+     */
+    static std::filesystem::path default_directory();
+
+    MeshCache(const std::filesystem::path &directory, uint64_t max_size);
+
+    std::optional<CachedMesh> find(const std::string &model_fn) const;
+
+    //failing to store an entry only means the mesh is parsed again next time
+    void store(const std::string &model_fn, const Mesh &mesh, const Bounds &bounds) const;
+
+    void evict() const;
+};
+
+#endif
@@ -7,10 +7,10 @@
 #include <map>
 #include <vector>
 
-#include <IL/il.h>
-#include <IL/ilu.h>
 #include <GL/gl.h>
 
+#include "loader.hpp"
+
 
 class TexturesHandler {
 
@@ -21,12 +21,15 @@ private:
     std::map<std::string, unsigned> image_info;
 
 
-    TexturesHandler(const std::set<std::string> &textures_fns);
+    TexturesHandler();
 
 public:
-    static void init(const std::set<std::string> &textures_fns);
+    static void init();
     static std::shared_ptr<TexturesHandler> get_instance();
 
+    //upload an image handed over by the AssetStreamer, releasing its pixels once it is on the GPU
+    void add_image(const std::string &texture_fn, LoadedImage &image);
+
     bool bind(const std::string& texture_fn) const;
     void clear() const;
 };
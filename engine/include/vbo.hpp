@@ -5,12 +5,15 @@
 #include <set>
 #include <map>
 #include <string>
+#include <array>
 #include <fstream>
 
 #include <GL/glew.h>
 
 #include "point.hpp"
 #include "file_handler.hpp"
+#include "loader.hpp"
+#include "culling.hpp"
 
 
 
@@ -27,17 +30,45 @@ private:
     std::map<std::string, std::pair<unsigned, size_t>> model_info;
     std::map<std::string, std::pair<unsigned, size_t>> normals_info;
     std::map<std::string, std::pair<unsigned, size_t>> text_coords_info;
+    std::map<std::string, std::pair<unsigned, size_t>> indexes_info;
 
+    /**
+     * Quantized models are uploaded as 16 bit integers and dequantized
+     * by the modelview and texture matrices when drawn
+     */
+    struct Dequantization {
+        std::array<QuantizationRange, 3> position_ranges;
+        std::array<QuantizationRange, 2> text_coord_ranges;
+        GLenum normal_type;
+    };
+    std::map<std::string, Dequantization> quantized_info;
+
+    //models uploaded as floats rather than doubles, as cached ones are
+    std::set<std::string> single_precision;
+
+    std::map<std::string, Bounds> bounds_info;
 
-    VBO(const std::set<std::string> &model_fns);
+    //models split into meshlets have each one culled on its own
+    std::map<std::string, std::vector<Meshlet>> meshlets_info;
+
+    unsigned upload_mesh(const std::string &model_fn, const Mesh &mesh, unsigned buffer_count);
+    unsigned upload_quantized_mesh(const std::string &model_fn, const QuantizedMesh &qmesh, unsigned buffer_count);
+    unsigned upload_cached_mesh(const std::string &model_fn, const CachedMesh &cached, unsigned buffer_count);
+
+
+    VBO();
 
 public:
-    static void init(const std::set<std::string> &model_fns);
+    static void init();
     static std::shared_ptr<VBO> get_instance();
 
-    bool render(const std::string &model_fn) const;
+    //upload a model handed over by the AssetStreamer, releasing its memory once it is on the GPU
+    void add_model(const std::string &model_fn, LoadedModel &model);
+
+    bool render(const std::string &model_fn, const Culler &culler) const;
 
     bool has_texture(const std::string &model_fn) const;
+    const Bounds* get_bounds(const std::string &model_fn) const;
 
     void enable_client_state() const;
     void disable_client_state() const;
@@ -0,0 +1,148 @@
+#include "culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+using std::array;
+using std::pair;
+
+
+
+static double dot(const CartPoint3d &a, const CartPoint3d &b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static double length(const CartPoint3d &a){
+    return std::sqrt(dot(a, a));
+}
+
+Culler::Culler(const array<double, 16> &projection, const array<double, 16> &modelview) :
+    planes(), modelview(modelview), scale(0.0), keeps_angles(false)
+{
+    /**
+     * A point in eye coordinates is inside the frustum if each of its clip coordinates
+     * lies within [-w, w], i.e. w + x >= 0, w - x >= 0 and so on, where
+     * each clip coordinate is the dot product of a row of the projection with the point
+     */
+    const auto row { [&projection](size_t i){
+        return array<double, 4>{ projection[i], projection[4 + i], projection[8 + i], projection[12 + i] };
+    } };
+
+    const array<double, 4> w { row(3) };
+
+    for(size_t axis{}; axis < 3; ++axis){
+
+        const array<double, 4> r { row(axis) };
+
+        for(size_t c{}; c < 4; ++c){
+            this->planes[2 * axis][c] = w[c] + r[c];
+            this->planes[2 * axis + 1][c] = w[c] - r[c];
+        }
+    }
+
+    //normalized, so that plane distances are in eye units
+    for(auto &plane : this->planes){
+
+        const double norm { length({ plane[0], plane[1], plane[2] }) };
+
+        if(norm > 0.0)
+            for(double &c : plane)
+                c /= norm;
+    }
+
+    const array<CartPoint3d, 3> columns {
+        CartPoint3d{ modelview[0], modelview[1], modelview[2] },
+        CartPoint3d{ modelview[4], modelview[5], modelview[6] },
+        CartPoint3d{ modelview[8], modelview[9], modelview[10] }
+    };
+
+    const array<double, 3> lengths { length(columns[0]), length(columns[1]), length(columns[2]) };
+    const double max_length { std::max({ lengths[0], lengths[1], lengths[2] }) };
+    const double tolerance { 1e-6 * max_length };
+
+    //mirroring modelviews flip the winding OpenGL culls by, so they are left alone too
+    const double determinant { dot(columns[0], cross_product(columns[1], columns[2])) };
+
+    this->keeps_angles =
+        max_length > 0.0 &&
+        std::abs(lengths[0] - lengths[1]) <= tolerance &&
+        std::abs(lengths[0] - lengths[2]) <= tolerance &&
+        std::abs(dot(columns[0], columns[1])) <= tolerance * max_length &&
+        std::abs(dot(columns[0], columns[2])) <= tolerance * max_length &&
+        std::abs(dot(columns[1], columns[2])) <= tolerance * max_length &&
+        determinant > 0.0;
+
+    //otherwise, the Frobenius norm bounds how much any length is stretched
+    this->scale = this->keeps_angles ?
+        max_length :
+        std::sqrt(lengths[0] * lengths[0] + lengths[1] * lengths[1] + lengths[2] * lengths[2]);
+}
+
+CartPoint3d Culler::to_eye(const array<double, 3> &p) const {
+
+    const array<double, 16> &m { this->modelview };
+
+    return {
+        m[0] * p[0] + m[4] * p[1] + m[8]  * p[2] + m[12],
+        m[1] * p[0] + m[5] * p[1] + m[9]  * p[2] + m[13],
+        m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14]
+    };
+}
+
+bool Culler::in_frustum(const CartPoint3d &center, double radius) const {
+
+    for(auto const& plane : this->planes)
+        if(plane[0] * center.x + plane[1] * center.y + plane[2] * center.z + plane[3] < -radius)
+            return false;
+
+    return true;
+}
+
+//models without bounds are always drawn
+bool Culler::is_visible(const Bounds &bounds) const {
+    return bounds.empty || this->in_frustum(this->to_eye(bounds.center.as_array()), bounds.radius * this->scale);
+}
+
+bool Culler::is_visible(const Meshlet &meshlet) const {
+
+    const CartPoint3d center { this->to_eye(meshlet.center) };
+    const double radius { meshlet.radius * this->scale };
+
+    if(!this->in_frustum(center, radius))
+        return false;
+
+    if(!this->keeps_angles || meshlet.cone_cutoff >= 1.0)
+        return true;
+
+    //the camera is at the origin of eye coordinates, see Meshlet
+    const array<double, 16> &m { this->modelview };
+    const array<double, 3> &a { meshlet.cone_axis };
+
+    const CartPoint3d axis {
+        (m[0] * a[0] + m[4] * a[1] + m[8]  * a[2]) / this->scale,
+        (m[1] * a[0] + m[5] * a[1] + m[9]  * a[2]) / this->scale,
+        (m[2] * a[0] + m[6] * a[1] + m[10] * a[2]) / this->scale
+    };
+
+    return dot(center, axis) < meshlet.cone_cutoff * length(center) + radius;
+}
+
+vector<pair<uint32_t, uint32_t>> Culler::visible_ranges(const vector<Meshlet> &meshlets) const {
+
+    vector<pair<uint32_t, uint32_t>> ranges {};
+
+    for(auto const& m : meshlets){
+
+        if(!this->is_visible(m))
+            continue;
+
+        //meshlets are laid out one after the other, so neighbouring visible ones make up a single draw
+        if(ranges.size() > 0 && ranges.back().first + ranges.back().second == m.first_index)
+            ranges.back().second += m.index_count;
+        else
+            ranges.emplace_back(m.first_index, m.index_count);
+    }
+
+    return ranges;
+}
@@ -23,9 +23,23 @@ static Constant<shared_ptr<TexturesHandler>> textures_wrapper {};
 
 static Constant<int> tesselation {};
 
-static Constant<map<string, vector<CartPoint3d>>> points_to_draw {};
-static Constant<map<string, vector<CartPoint3d>>> normals_to_draw {};
-static Constant<map<string, vector<CartPoint2d>>> text_coords_to_draw {};
+//maximum size of the mesh cache in bytes, if one is used, see MeshCache
+static Constant<optional<uint64_t>> cache_size {};
+
+//filled in as models are streamed in, see upload_assets
+static map<string, vector<CartPoint3d>> points_to_draw {};
+static map<string, vector<CartPoint3d>> normals_to_draw {};
+static map<string, vector<CartPoint2d>> text_coords_to_draw {};
+static map<string, vector<Meshlet>> meshlets_to_draw {};
+
+//bounds of each model in its own coordinates, in either mode
+static map<string, Bounds> models_bounds {};
+
+//loads assets in the background until every one is uploaded, after which it is reset
+static unique_ptr<AssetStreamer> asset_streamer {};
+
+//time each frame may spend uploading streamed assets, so that the scene stays interactive meanwhile
+static constexpr double UPLOAD_BUDGET_MS { 4.0 };
 
 
 static Constant<vector<unique_ptr<Light>>> lights {};
@@ -215,6 +229,12 @@ static inline void compute_fps(){
                       << " --- FPS: "
                       << fps;
 
+        if(asset_streamer != nullptr)
+            string_buffer << " --- Loading: "
+                          << asset_streamer->taken_count()
+                          << '/'
+                          << asset_streamer->total_count();
+
         glutSetWindowTitle(string_buffer.str().c_str());
 
         frames = 0;
@@ -324,11 +344,108 @@ static inline void set_material_color(const Color& color){
     glMateriali(GL_FRONT, GL_SHININESS, static_cast<int>(color.shininess));
 }
 
+//whether the model is, as far as its bounds tell, at least partly inside the view frustum
+static bool is_model_visible(const string &model_fn, const Culler &culler){
+
+    auto const bounds { models_bounds.find(model_fn) };
+
+    return bounds == models_bounds.end() || culler.is_visible(bounds->second);
+}
+
+//add a model, handed over by the streamer, to what is drawn
+static void add_model(const string &model_fn, LoadedModel &model){
+
+    if(model.code != ErrorCode::success)
+        return;
+
+    if(as_vbo.value()){
+
+        vbo_wrapper.value()->add_model(model_fn, model);
+
+        const Bounds *bounds { vbo_wrapper.value()->get_bounds(model_fn) };
+        if(bounds != nullptr)
+            models_bounds.insert( { model_fn, *bounds } );
+
+        return;
+    }
+
+    Mesh &mesh { model.mesh };
+
+    //immediate mode draws triangle soups only
+    expand_indexes(mesh);
+    auto& [vertexes, normals, text_coords, _, meshlets] { mesh };
+
+    points_to_draw.insert(
+        { model_fn, std::move(vertexes) }
+    );
+
+    models_bounds.insert( { model_fn, model.bounds } );
+
+    if(normals.size() > 0)
+        normals_to_draw.insert(
+            { model_fn, std::move(normals) }
+        );
+
+    if(text_coords.size() > 0)
+        text_coords_to_draw.insert(
+            { model_fn, std::move(text_coords) }
+        );
+
+    if(meshlets.size() > 0)
+        meshlets_to_draw.insert(
+            { model_fn, std::move(meshlets) }
+        );
+}
+
+/**
+ * Upload the assets the streamer is done with, for as long as the frame's budget allows,
+ * though always at least one, so that loading never stalls behind a slow frame
+ * A single model is never split across frames, so the largest ones may overrun the budget
+ */
+static void upload_assets(){
+
+    if(asset_streamer == nullptr)
+        return;
+
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point begin { clock::now() };
+    const auto within_budget {
+        [&begin](){
+            const std::chrono::duration<double, std::milli> elapsed { clock::now() - begin };
+            return elapsed.count() < UPLOAD_BUDGET_MS;
+        }
+    };
+
+    do {
+
+        //textures first, as they are cheaper to upload and models look wrong without them
+        if(auto image { asset_streamer->take_image() }; image.has_value())
+            textures_wrapper.value()->add_image(image->first, image->second);
+
+        else if(auto model { asset_streamer->take_model() }; model.has_value())
+            add_model(model->first, model->second);
+
+        else
+            break;
+
+    } while(within_budget());
+
+    //joins the workers, which are done by now
+    if(asset_streamer->taken_count() == asset_streamer->total_count())
+        asset_streamer.reset();
+}
+
 static void render_scene(){
 
+    upload_assets();
+
     // clear buffers
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    array<double, 16> projection {};
+    glGetDoublev(GL_PROJECTION_MATRIX, projection.data());
+
     // set the camera
     glLoadIdentity();
 
@@ -467,12 +584,21 @@ static void render_scene(){
             }
 
 
+        //every model of the group is drawn through the same modelview
+        array<double, 16> modelview {};
+        glGetDoublev(GL_MODELVIEW_MATRIX, modelview.data());
+
+        const Culler culler { projection, modelview };
+
         if(as_vbo.value()){
 
             vbo_wrapper.value()->enable_client_state();
 
             for(auto const& m : group->models){
 
+                if(!is_model_visible(m.model_filename, culler))
+                    continue;
+
                 if(lighting_enabled)
                     set_material_color(m.color);
 
@@ -481,7 +607,7 @@ static void render_scene(){
                 else
                     textures_wrapper.value()->clear();
 
-                vbo_wrapper.value()->render(m.model_filename);
+                vbo_wrapper.value()->render(m.model_filename, culler);
             }
 
             vbo_wrapper.value()->disable_client_state();
@@ -490,19 +616,22 @@ static void render_scene(){
 
             for(auto const& m : group->models){
 
+                const string& model_fn { m.model_filename };
+
+                if(!is_model_visible(model_fn, culler))
+                    continue;
+
                 if(lighting_enabled)
                     set_material_color(m.color);
 
-                const string& model_fn { m.model_filename };
-
-                const bool has_vertexes { points_to_draw.value().count(model_fn) > 0 };
+                const bool has_vertexes { points_to_draw.count(model_fn) > 0 };
                 if(has_vertexes){
 
-                    const bool has_normals { normals_to_draw.value().count(model_fn) > 0 };
-                    const bool has_text_coords { text_coords_to_draw.value().count(model_fn) > 0 };
+                    const bool has_normals { normals_to_draw.count(model_fn) > 0 };
+                    const bool has_text_coords { text_coords_to_draw.count(model_fn) > 0 };
 
                     const vector<CartPoint3d>& vertexes {
-                        points_to_draw.value().at(model_fn)
+                        points_to_draw.at(model_fn)
                     };
 
 
@@ -512,30 +641,41 @@ static void render_scene(){
                         textures_wrapper.value()->clear();
 
 
+                    //the vertexes of the soup are in the same order as the indexes meshlets refer to
+                    auto const meshlets { meshlets_to_draw.find(model_fn) };
+
+                    const vector<pair<uint32_t, uint32_t>> ranges {
+                        meshlets != meshlets_to_draw.end() ?
+                            culler.visible_ranges(meshlets->second) :
+                            vector<pair<uint32_t, uint32_t>>{ { 0, static_cast<uint32_t>(vertexes.size()) } }
+                    };
+
+
                     glBegin(GL_TRIANGLES);
 
-                    for(unsigned i{}; i < vertexes.size(); ++i){
+                    for(auto const& [first, count] : ranges)
+                        for(unsigned i { first }; i < first + count; ++i){
 
-                        if(has_text_coords){
+                            if(has_text_coords){
 
-                            const vector<CartPoint2d>& text_coords {
-                                text_coords_to_draw.value().at(model_fn)
-                            };
+                                const vector<CartPoint2d>& text_coords {
+                                    text_coords_to_draw.at(model_fn)
+                                };
 
-                            glTexCoord2d(text_coords.at(i).x, text_coords.at(i).y);
-                        }
+                                glTexCoord2d(text_coords.at(i).x, text_coords.at(i).y);
+                            }
 
-                        if(has_normals){
+                            if(has_normals){
 
-                            const vector<CartPoint3d>& normals {
-                                normals_to_draw.value().at(model_fn)
-                            };
+                                const vector<CartPoint3d>& normals {
+                                    normals_to_draw.at(model_fn)
+                                };
 
-                            glNormal3d(normals.at(i).x, normals.at(i).y, normals.at(i).z);
-                        }
+                                glNormal3d(normals.at(i).x, normals.at(i).y, normals.at(i).z);
+                            }
 
-                        glVertex3d(vertexes.at(i).x, vertexes.at(i).y, vertexes.at(i).z);
-                    }
+                            glVertex3d(vertexes.at(i).x, vertexes.at(i).y, vertexes.at(i).z);
+                        }
 
                     glEnd();
                 }
@@ -575,78 +715,40 @@ static void gl_start(int argc, char** argv){
 
 
 
-     set<string> images_set {};
-
-    if(!as_vbo.value()){
-
-        map<string, vector<CartPoint3d>> tmp_points_to_draw {};
-        map<string, vector<CartPoint3d>> tmp_normals_to_draw {};
-        map<string, vector<CartPoint2d>> tmp_text_coords_to_draw {};
-
-        for(auto const& group : groups.value())
-
-            for(auto const& m : group->models){
-
-                const string& model_fn { m.model_filename };
-
-                //count returns number of mappings for the given key
-
-                if(tmp_points_to_draw.count(model_fn)  == 0 &&
-                   tmp_normals_to_draw.count(model_fn) == 0){
-
-                    auto const& [code, vertexes, normals, text_coords] { files_reader(model_fn) };
-
-                    if(code == ErrorCode::success){
-                        tmp_points_to_draw.insert(
-                            { model_fn, std::move(vertexes) }
-                        );
-
-                        if(normals.size() > 0)
-                            tmp_normals_to_draw.insert(
-                                { model_fn, std::move(normals) }
-                            );
-
-                        if(text_coords.size() > 0)
-                            tmp_text_coords_to_draw.insert(
-                                { model_fn, std::move(text_coords) }
-                            );
-                    }
-                }
-
-                if(m.texture_filename.has_value())
-                    images_set.insert(m.texture_filename.value());
-            }
+    /**
+    * Avoid repeated elements i.e. multiples references
+    * to the same .3d file
+    */
 
-        points_to_draw  = std::move(tmp_points_to_draw);
-        normals_to_draw = std::move(tmp_normals_to_draw);
-        text_coords_to_draw = std::move(tmp_text_coords_to_draw);
-    }
-    else{
-
-        /**
-        * Avoid repeated elements i.e. multiples references
-        * to the same .3d file
-        */
+    set<string> models_set {};
+    set<string> images_set {};
 
-        set<string> models_set {};
+    for(auto const& group : groups.value())
 
-        for(auto const& group : groups.value())
+        for(auto const& m : group->models){
 
-            for(auto const& m : group->models){
+            models_set.insert(m.model_filename);
 
-                models_set.insert(m.model_filename);
+            if(m.texture_filename.has_value())
+                images_set.insert(m.texture_filename.value());
+        }
 
-                if(m.texture_filename.has_value())
-                    images_set.insert(m.texture_filename.value());
-            }
+    //the cache holds models as uploaded to buffers, so immediate mode parses them every time
+    optional<MeshCache> cache {};
+    if(as_vbo.value() && cache_size.value().has_value())
+        cache.emplace(MeshCache::default_directory(), cache_size.value().value());
 
-        VBO::init(models_set);
+    if(as_vbo.value()){
+        VBO::init();
         vbo_wrapper = VBO::get_instance();
     }
 
-    TexturesHandler::init(images_set);
+    TexturesHandler::init();
     textures_wrapper = TexturesHandler::get_instance();
 
+    //everything is read and decoded in the background, on every core, while the scene is drawn as it comes in
+    asset_streamer = std::make_unique<AssetStreamer>(models_set, images_set, as_vbo.value(), std::move(cache));
+
 
     // OpenGL settings
     glEnable(GL_DEPTH_TEST);
@@ -683,16 +785,46 @@ static void gl_start(int argc, char** argv){
 
 ErrorCode start(int argc, char** argv){
 
-    if(argc == 1)
+    //options may come anywhere, the remaining arguments being positional
+    vector<string> args {};
+    bool no_cache { false };
+    uint64_t cache_mib { MeshCache::DEFAULT_MAX_SIZE >> 20 };
+
+    for(int i { 1 }; i < argc; ++i){
+
+        const string arg { argv[i] };
+
+        if(arg == "--no-cache")
+            no_cache = true;
+
+        else if(arg == "--cache-size"){
+
+            if(i + 1 >= argc)
+                return ErrorCode::not_enough_args;
+
+            const int mib { string_to_uint(argv[++i]) };
+            if(mib < 0)
+                return ErrorCode::invalid_argument;
+
+            cache_mib = static_cast<uint64_t>(mib);
+        }
+
+        else
+            args.push_back(arg);
+    }
+
+    if(args.size() == 0)
         return ErrorCode::not_enough_args;
 
+    cache_size = no_cache ? optional<uint64_t>{} : optional<uint64_t>{ cache_mib << 20 };
+
 
-    const string filename { argv[1] };
+    const string filename { args[0] };
 
-    if(argc >= 3){
-        if(argv[2][0] == 'n' || argv[2][0] == 'N')
+    if(args.size() >= 2){
+        if(args[1][0] == 'n' || args[1][0] == 'N')
             as_vbo = false;
-        else if(argv[2][0] == 'y' || argv[2][0] == 'Y')
+        else if(args[1][0] == 'y' || args[1][0] == 'Y')
             as_vbo = true;
         else
             return ErrorCode::invalid_argument;
@@ -700,8 +832,8 @@ ErrorCode start(int argc, char** argv){
     else
         as_vbo = true;
 
-    if(argc >= 4){
-        const int aux_tess { string_to_uint(argv[3]) };
+    if(args.size() >= 3){
+        const int aux_tess { string_to_uint(args[2]) };
         if(aux_tess > 0)
             tesselation = aux_tess;
         else
@@ -2,7 +2,11 @@
 
 static void usage(){
     std::cerr << "Usage: \n" <<
-        "\t engine <xml_file> [use_vbos:y|n] [dynamic_translate_tesselation_level]\n";
+        "\t engine <xml_file> [use_vbos:y|n] [dynamic_translate_tesselation_level]\n" <<
+        "Options: \n" <<
+        "\t --no-cache\t parse text models every time, rather than map them from the mesh cache\n" <<
+        "\t --cache-size <MiB>\t evict the least recently used models once the mesh cache grows past this\n" <<
+        "\t                   \t (1024 by default), the cache being in $XDG_CACHE_HOME/cg-engine\n";
 }
 
 void handle_error(const ErrorCode e){
@@ -1,66 +1,105 @@
 #include "file_handler.hpp"
 
+#include <mutex>
+
 using std::vector;
 using std::string;
 using std::tuple;
 
 
 
-template<typename T>
-static tuple<ErrorCode, vector<T>> file_reader(const string& fn){
+//models are read on several threads at once, whose warnings would otherwise interleave
+static std::mutex warnings_mutex {};
+
+static tuple<ErrorCode, ErrorCode, ErrorCode, Mesh> binary_reader(const string &model_fn){
 
-    static_assert(
-        std::is_same<T, CartPoint3d>::value ||
-        std::is_same<T, CartPoint2d>::value
-    );
+    auto&& [code, mesh] { read_binary_mesh(model_fn) };
 
-    vector<T> points {};
+    const ErrorCode ncode {
+        (mesh.normals.size() > 0) ? ErrorCode::success : ErrorCode::invalid_file_formatting
+    };
+    const ErrorCode tcode {
+        (mesh.text_coords.size() > 0) ? ErrorCode::success : ErrorCode::invalid_file_formatting
+    };
 
-    std::ifstream file{};
-    file.open(fn, std::ios::in);
+    return { code, ncode, tcode, std::move(mesh) };
+}
 
-    if(!file.is_open())
-        return {
-            ErrorCode::io_error,
-            std::move(points)
-        };
+/**
+ * Bounds of a model, as stored in its binary header or in the .bounds file of a text model
+ * Models written before bounds were stored have them computed from their vertexes instead
+ */
+static Bounds bounds_reader(const string &model_fn, const Mesh &mesh){
 
+    Bounds bounds {};
 
-    T p1{}, p2{}, p3{};
-    while(file >> p1 >> p2 >> p3){
-        points.push_back(p1);
-        points.push_back(p2);
-        points.push_back(p3);
+    if(is_binary_mesh(model_fn)){
+        auto const& [code, header] { read_binary_mesh_header(model_fn) };
+        if(code == ErrorCode::success)
+            bounds = header_bounds(header);
+    }
+    else{
+        auto const& [code, text_bounds] { read_bounds(to_bounds_extension(model_fn)) };
+        if(code == ErrorCode::success)
+            bounds = text_bounds;
     }
 
-    return {
-        ErrorCode::success,
-        std::move(points)
+    if(bounds.empty)
+        bounds = points_bounds(mesh.vertexes);
+
+    return bounds;
+}
+
+tuple<ErrorCode, Mesh, Bounds> files_reader(const string &model_fn, unsigned threads){
+
+    /**
+     * Binary meshes hold every attribute in the .3d file itself,
+     * whereas text meshes are split into .3d, .norm and .text files
+     */
+    auto&& [vcode, ncode, tcode, mesh] {
+        is_binary_mesh(model_fn) ? binary_reader(model_fn) : read_text_mesh(model_fn, threads)
     };
+
+    static const string warning { "\033[35;1mWarning:\033[0m " };
+
+    {
+        const std::lock_guard<std::mutex> lock { warnings_mutex };
+
+        if(vcode != ErrorCode::success)
+            std::cout << warning << "Unable to load vertexes for model '" << model_fn << "'.\n";
+
+        if(ncode != ErrorCode::success)
+            std::cout << warning << "Unable to load normals for model '" << model_fn << "'.\n";
+
+        if(tcode != ErrorCode::success)
+            std::cout << warning << "Unable to load texture coordinates for model '" << model_fn << "'.\n";
+    }
+
+    const Bounds bounds { bounds_reader(model_fn, mesh) };
+
+    return { vcode, std::move(mesh), bounds };
 }
 
-tuple<ErrorCode, vector<CartPoint3d>, vector<CartPoint3d>, vector<CartPoint2d>>
-files_reader(const string &model_fn){
+//read a quantized mesh, to be uploaded without dequantizing it
+tuple<ErrorCode, QuantizedMesh, Bounds> quantized_reader(const string &model_fn){
 
-    auto const& [vcode, vertexes] { file_reader<CartPoint3d>(model_fn) };
-    auto const& [ncode, normals] { file_reader<CartPoint3d>(to_norm_extension(model_fn)) };
-    auto const& [tcode, text_coords] { file_reader<CartPoint2d>(to_text_extension(model_fn)) };
+    auto&& [code, qmesh] { read_quantized_mesh(model_fn) };
+    auto const& [hcode, header] { read_binary_mesh_header(model_fn) };
 
     static const string warning { "\033[35;1mWarning:\033[0m " };
+    const std::lock_guard<std::mutex> lock { warnings_mutex };
 
-    if(vcode != ErrorCode::success)
+    if(code != ErrorCode::success)
         std::cout << warning << "Unable to load vertexes for model '" << model_fn << "'.\n";
 
-    if(ncode != ErrorCode::success)
-        std::cout << warning << "Unable to load normals for model '" << model_fn << "'.\n";
+    else{
+        if(qmesh.normals.size() == 0)
+            std::cout << warning << "Unable to load normals for model '" << model_fn << "'.\n";
 
-    if(tcode != ErrorCode::success)
-        std::cout << warning << "Unable to load texture coordinates for model '" << model_fn << "'.\n";
+        if(qmesh.text_coords.size() == 0)
+            std::cout << warning << "Unable to load texture coordinates for model '" << model_fn << "'.\n";
+    }
 
-    return tuple{
-        vcode,
-        std::move(vertexes),
-        std::move(normals),
-        std::move(text_coords)
-    };
+    //quantized meshes always store at least their bounding box
+    return { code, std::move(qmesh), header_bounds(header) };
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "loader.hpp"
+#include "file_handler.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include <IL/il.h>
+#include <IL/ilu.h>
+
+using std::vector;
+using std::string;
+using std::set;
+using std::optional;
+using std::pair;
+
+
+
+LoadedModel::LoadedModel() :
+    code(ErrorCode::io_error), quantized(false), mesh(), qmesh(), cached(), bounds() {}
+
+LoadedImage::LoadedImage() :
+    width(0), height(0), pixels() {}
+
+
+
+AssetStreamer::AssetStreamer(const set<string> &model_fns, const set<string> &image_fns, bool keep_quantized,
+                             optional<MeshCache> &&cache) :
+    models(), images(), keep_quantized(keep_quantized), cache(std::move(cache)), tasks(),
+    next_task(0), finished_tasks(0), stopping(false), spare_threads(0), mutex(), ready_models(), ready_images(),
+    taken(0), pool() {
+
+    //every entry is in place before the workers start, so that each only ever touches its own
+    for(auto const& model_fn : model_fns)
+        this->models.emplace_back(model_fn, LoadedModel{});
+
+    for(auto const& image_fn : image_fns)
+        this->images.emplace_back(image_fn, LoadedImage{});
+
+    //first, so that the longest chain of work starts right away
+    if(this->images.size() > 0){
+        ilInit();
+        this->tasks.emplace_back([this](){ this->decode_images(); });
+    }
+
+    for(size_t m{}; m < this->models.size(); ++m)
+        this->tasks.emplace_back([this, m](){ this->load_model(m); });
+
+    //may be 0 if it isn't computable
+    const unsigned cores { std::thread::hardware_concurrency() };
+    const size_t workers { std::min<size_t>(cores > 0 ? cores : 1, this->tasks.size()) };
+
+    this->spare_threads = static_cast<unsigned>((cores > 0 ? cores : 1) - workers);
+
+    //workers take the next task whenever they are done with one, and lend their thread once out of them
+    const auto worker {
+        [this](){
+            for(size_t t { this->next_task++ }; t < this->tasks.size() && !this->stopping; t = this->next_task++){
+                this->tasks[t]();
+                this->finish_task();
+            }
+
+            ++this->spare_threads;
+        }
+    };
+
+    for(size_t w{}; w < workers; ++w)
+        this->pool.emplace_back(worker);
+}
+
+AssetStreamer::~AssetStreamer(){
+
+    this->stopping = true;
+
+    for(auto& w : this->pool)
+        w.join();
+}
+
+void AssetStreamer::load_model(size_t m){
+
+    const string &model_fn { this->models[m].first };
+    LoadedModel &model { this->models[m].second };
+
+    model.quantized = this->keep_quantized && is_quantized_mesh(model_fn);
+
+    //binary meshes are read as fast as cached ones would be
+    const bool cacheable { this->cache.has_value() && !is_binary_mesh(model_fn) };
+
+    if(cacheable)
+        model.cached = this->cache->find(model_fn);
+
+    if(model.cached.has_value()){
+        model.code = ErrorCode::success;
+        model.bounds = model.cached->bounds;
+    }
+    else if(model.quantized){
+        auto&& [code, qmesh, bounds] { quantized_reader(model_fn) };
+        model.code = code;
+        model.qmesh = std::move(qmesh);
+        model.bounds = bounds;
+    }
+    else{
+        //every spare thread is taken, so that the first large model read gets them all
+        const unsigned lent { this->spare_threads.exchange(0) };
+
+        auto&& [code, mesh, bounds] { files_reader(model_fn, 1 + lent) };
+        model.code = code;
+        model.mesh = std::move(mesh);
+        model.bounds = bounds;
+
+        this->spare_threads += lent;
+
+        if(cacheable && model.code == ErrorCode::success)
+            this->cache->store(model_fn, model.mesh, model.bounds);
+    }
+
+    std::lock_guard<std::mutex> lock { this->mutex };
+    this->ready_models.push_back(m);
+}
+
+//decode every image in turn into a single DevIL image, copying out its pixels and handing each over right away
+void AssetStreamer::decode_images(){
+
+    ILuint name {};
+    ilGenImages(1, &name);
+    ilBindImage(name);
+
+    for(size_t i{}; i < this->images.size() && !this->stopping; ++i){
+
+        const string &image_fn { this->images[i].first };
+        LoadedImage &image { this->images[i].second };
+
+        if(ilLoadImage(image_fn.c_str()) == IL_FALSE){
+
+            std::cerr << "\033[33;1mWarning:\033[0m Unable to load image '"
+                      << image_fn
+                      << "'.\n";
+        }
+        else{
+
+            ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+
+            ILinfo image_info {};
+            iluGetImageInfo(&image_info);
+            if(image_info.Origin == IL_ORIGIN_UPPER_LEFT)
+                iluFlipImage();
+
+            const int width { ilGetInteger(IL_IMAGE_WIDTH) };
+            const int height { ilGetInteger(IL_IMAGE_HEIGHT) };
+
+            if(width > 0 && height > 0){
+
+                const unsigned char *data { ilGetData() };
+                const size_t size { 4 * static_cast<size_t>(width) * static_cast<size_t>(height) };
+
+                image.width = width;
+                image.height = height;
+                image.pixels.assign(data, data + size);
+            }
+        }
+
+        //images that failed are handed over all the same, so that they are counted as done
+        std::lock_guard<std::mutex> lock { this->mutex };
+        this->ready_images.push_back(i);
+    }
+
+    ilDeleteImages(1, &name);
+}
+
+void AssetStreamer::finish_task(){
+
+    //only once every entry is written, as workers would otherwise race to remove them
+    if(++this->finished_tasks == this->tasks.size() && this->cache.has_value())
+        this->cache->evict();
+}
+
+optional<pair<string, LoadedModel>> AssetStreamer::take_model(){
+
+    std::lock_guard<std::mutex> lock { this->mutex };
+
+    if(this->ready_models.empty())
+        return std::nullopt;
+
+    const size_t m { this->ready_models.front() };
+    this->ready_models.pop_front();
+    ++this->taken;
+
+    //the worker is done with it, and nothing else ever touches it again
+    return std::move(this->models[m]);
+}
+
+optional<pair<string, LoadedImage>> AssetStreamer::take_image(){
+
+    std::lock_guard<std::mutex> lock { this->mutex };
+
+    if(this->ready_images.empty())
+        return std::nullopt;
+
+    const size_t i { this->ready_images.front() };
+    this->ready_images.pop_front();
+    ++this->taken;
+
+    return std::move(this->images[i]);
+}
+
+size_t AssetStreamer::taken_count(){
+    std::lock_guard<std::mutex> lock { this->mutex };
+    return this->taken;
+}
+
+size_t AssetStreamer::total_count() const {
+    return this->models.size() + this->images.size();
+}
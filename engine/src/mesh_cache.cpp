@@ -0,0 +1,378 @@
+#include "mesh_cache.hpp"
+#include "filters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+using std::string;
+using std::vector;
+using std::array;
+using std::optional;
+
+namespace fs = std::filesystem;
+
+
+
+static constexpr array<char, 4> CACHE_MAGIC { 'C', 'G', 'M', 'C' };
+
+//bumped whenever the layout of entries changes, so that older ones are rebuilt
+static constexpr uint32_t CACHE_VERSION { 1 };
+
+static constexpr const char *ENTRY_EXTENSION { ".mesh" };
+
+//the .3d, .norm, .text and .bounds files an entry is made from
+static constexpr size_t SOURCE_COUNT { 4 };
+
+/**
+ * An entry is this header followed by vertex_count positions, normals and texture coordinates
+ * as floats, then index_count 32 bit indexes and meshlet_count Meshlets, all in native byte order
+ * Missing source files are stamped with a size and time of 0
+ */
+struct CacheHeader {
+    array<char, 4> magic;
+    uint32_t version;
+    uint32_t mesh_version;      //Meshlets are laid out as in binary meshes of this version
+    uint32_t padding;
+
+    array<uint64_t, SOURCE_COUNT> source_sizes;
+    array<int64_t, SOURCE_COUNT> source_times;
+    uint64_t content_hash;
+
+    uint64_t vertex_count;
+    uint64_t index_count;
+    uint64_t meshlet_count;
+
+    array<double, 3> bounds_min;
+    array<double, 3> bounds_max;
+    array<double, 3> sphere_center;
+    double sphere_radius;
+    uint64_t bounds_empty;
+};
+
+static_assert(sizeof(CacheHeader) == 200);
+
+//the whole size of an entry with the counts in header, or 0 if it would overflow
+static uint64_t entry_size(const CacheHeader &header){
+
+    static constexpr uint64_t VERTEX_SIZE { 8 * sizeof(float) };
+    static constexpr uint64_t LIMIT { uint64_t{ 1 } << 48 };
+
+    if(header.vertex_count > LIMIT || header.index_count > LIMIT || header.meshlet_count > LIMIT)
+        return 0;
+
+    return sizeof(CacheHeader) + header.vertex_count * VERTEX_SIZE +
+           header.index_count * sizeof(uint32_t) + header.meshlet_count * sizeof(Meshlet);
+}
+
+
+
+static array<string, SOURCE_COUNT> source_files(const string &model_fn){
+    return {
+        model_fn, to_norm_extension(model_fn), to_text_extension(model_fn), to_bounds_extension(model_fn)
+    };
+}
+
+static void stamp_sources(const string &model_fn, CacheHeader &header){
+
+    const array<string, SOURCE_COUNT> sources { source_files(model_fn) };
+
+    for(size_t s{}; s < SOURCE_COUNT; ++s){
+
+        std::error_code size_error {}, time_error {};
+
+        const uintmax_t size { fs::file_size(sources[s], size_error) };
+        const fs::file_time_type time { fs::last_write_time(sources[s], time_error) };
+
+        header.source_sizes[s] = size_error ? 0 : static_cast<uint64_t>(size);
+        header.source_times[s] = time_error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+}
+
+/**
+ * FNV-1a over 8 bytes at a time, folding the high half back in after each step
+ * as multiplying only carries changes upwards, which is all telling edits apart takes,
+ * at several times the speed of hashing byte by byte
+ */
+static uint64_t hash_bytes(const char *data, size_t size, uint64_t hash){
+
+    static constexpr uint64_t PRIME { 1099511628211ULL };
+
+    size_t i {};
+
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)){
+
+        uint64_t word {};
+        std::memcpy(&word, data + i, sizeof(word));
+
+        hash = (hash ^ word) * PRIME;
+        hash ^= hash >> 32;
+    }
+
+    for(; i < size; ++i)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * PRIME;
+
+    //the size keeps the end of one file and the start of the next apart
+    return (hash ^ size) * PRIME;
+}
+
+static uint64_t hash_sources(const string &model_fn){
+
+    uint64_t hash { 14695981039346656037ULL };
+
+    for(auto const& source : source_files(model_fn)){
+
+        const MappedFile file { source };
+
+        if(file.is_open())
+            hash = hash_bytes(file.data(), file.size(), hash);
+    }
+
+    return hash;
+}
+
+template<typename T>
+static void write_floats(std::ofstream &file, const vector<T> &points){
+
+    static_assert(std::is_same<T, CartPoint3d>::value || std::is_same<T, CartPoint2d>::value);
+    static constexpr size_t DIMENSIONS { std::is_same<T, CartPoint3d>::value ? 3 : 2 };
+
+    vector<float> floats {};
+    floats.reserve(DIMENSIONS * points.size());
+
+    for(auto const& p : points){
+        floats.push_back(static_cast<float>(p.x));
+        floats.push_back(static_cast<float>(p.y));
+
+        if constexpr(DIMENSIONS == 3)
+            floats.push_back(static_cast<float>(p.z));
+    }
+
+    file.write(reinterpret_cast<const char*>(floats.data()), static_cast<std::streamsize>(floats.size() * sizeof(float)));
+}
+
+
+
+CachedMesh::CachedMesh() :
+    file(), vertexes(nullptr), normals(nullptr), text_coords(nullptr), indexes(nullptr),
+    vertex_count(0), index_count(0), meshlets(), bounds() {}
+
+
+
+MeshCache::MeshCache(const fs::path &directory, uint64_t max_size) :
+    directory(directory), max_size(max_size) {}
+
+fs::path MeshCache::default_directory(){
+
+    const char *xdg_cache { std::getenv("XDG_CACHE_HOME") };
+    if(xdg_cache != nullptr && *xdg_cache != '\0')
+        return fs::path{ xdg_cache } / "cg-engine";
+
+    const char *home { std::getenv("HOME") };
+    if(home != nullptr && *home != '\0')
+        return fs::path{ home } / ".cache" / "cg-engine";
+
+#ifdef _WIN32
+    //neither of the above is normally set on Windows
+    const char *local_app_data { std::getenv("LOCALAPPDATA") };
+    if(local_app_data != nullptr && *local_app_data != '\0')
+        return fs::path{ local_app_data } / "cg-engine";
+#endif
+
+    return ".cg-engine-cache";
+}
+
+//one entry per mesh path, named after its hash, so that rebuilding an entry replaces it
+fs::path MeshCache::entry_path(const string &model_fn) const {
+
+    std::error_code error {};
+    fs::path absolute { fs::absolute(model_fn, error) };
+
+    if(error)
+        absolute = model_fn;
+
+    const string name { absolute.lexically_normal().string() };
+
+    std::ostringstream hex {};
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash_bytes(name.data(), name.size(), 14695981039346656037ULL);
+
+    return this->directory / (hex.str() + ENTRY_EXTENSION);
+}
+
+optional<CachedMesh> MeshCache::find(const string &model_fn) const {
+
+    const fs::path entry { this->entry_path(model_fn) };
+
+    CachedMesh cached {};
+    cached.file = std::make_unique<MappedFile>(entry.string());
+
+    const MappedFile &file { *cached.file };
+
+    if(!file.is_open() || file.size() < sizeof(CacheHeader))
+        return std::nullopt;
+
+    CacheHeader header {};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if(header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.mesh_version != MESH_VERSION ||
+       entry_size(header) != file.size())
+        return std::nullopt;
+
+    CacheHeader sources {};
+    stamp_sources(model_fn, sources);
+
+    if(sources.source_sizes != header.source_sizes)
+        return std::nullopt;
+
+    //files merely touched, e.g. by checking them out again, keep their entry
+    if(sources.source_times != header.source_times){
+
+        if(hash_sources(model_fn) != header.content_hash)
+            return std::nullopt;
+
+        header.source_times = sources.source_times;
+
+        std::fstream rewrite {};
+        rewrite.open(entry, std::ios::in | std::ios::out | std::ios::binary);
+        rewrite.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    //the time of an entry is when it was last used
+    std::error_code error {};
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), error);
+
+    const size_t vertex_count { static_cast<size_t>(header.vertex_count) };
+    const char *data { file.data() + sizeof(CacheHeader) };
+
+    cached.vertexes = reinterpret_cast<const float*>(data);
+    cached.normals = cached.vertexes + 3 * vertex_count;
+    cached.text_coords = cached.normals + 3 * vertex_count;
+    cached.indexes = reinterpret_cast<const uint32_t*>(cached.text_coords + 2 * vertex_count);
+    cached.vertex_count = vertex_count;
+    cached.index_count = static_cast<size_t>(header.index_count);
+
+    cached.meshlets.resize(static_cast<size_t>(header.meshlet_count));
+    std::memcpy(static_cast<void*>(cached.meshlets.data()), cached.indexes + cached.index_count, cached.meshlets.size() * sizeof(Meshlet));
+
+    Bounds &bounds { cached.bounds };
+    bounds.min = { header.bounds_min[0], header.bounds_min[1], header.bounds_min[2] };
+    bounds.max = { header.bounds_max[0], header.bounds_max[1], header.bounds_max[2] };
+    bounds.center = { header.sphere_center[0], header.sphere_center[1], header.sphere_center[2] };
+    bounds.radius = header.sphere_radius;
+    bounds.empty = header.bounds_empty != 0;
+
+    return cached;
+}
+
+void MeshCache::store(const string &model_fn, const Mesh &mesh, const Bounds &bounds) const {
+
+    const size_t vertex_count { mesh.vertexes.size() };
+
+    if(vertex_count == 0 || mesh.normals.size() != vertex_count || mesh.text_coords.size() != vertex_count)
+        return;
+
+    std::error_code error {};
+    fs::create_directories(this->directory, error);
+
+    if(error)
+        return;
+
+    CacheHeader header {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.mesh_version = MESH_VERSION;
+
+    stamp_sources(model_fn, header);
+    header.content_hash = hash_sources(model_fn);
+
+    header.vertex_count = vertex_count;
+    header.index_count = mesh.indexes.size();
+    header.meshlet_count = mesh.meshlets.size();
+
+    header.bounds_min = bounds.min.as_array();
+    header.bounds_max = bounds.max.as_array();
+    header.sphere_center = bounds.center.as_array();
+    header.sphere_radius = bounds.radius;
+    header.bounds_empty = bounds.empty;
+
+    //written aside and renamed into place, so that a half written entry is never found
+    const fs::path entry { this->entry_path(model_fn) };
+    fs::path temporary { entry };
+    temporary += ".tmp";
+
+    std::ofstream file {};
+    file.open(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file.is_open())
+        return;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_floats(file, mesh.vertexes);
+    write_floats(file, mesh.normals);
+    write_floats(file, mesh.text_coords);
+    file.write(reinterpret_cast<const char*>(mesh.indexes.data()),
+               static_cast<std::streamsize>(mesh.indexes.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(mesh.meshlets.data()),
+               static_cast<std::streamsize>(mesh.meshlets.size() * sizeof(Meshlet)));
+    file.close();
+
+    if(!file)
+        fs::remove(temporary, error);
+
+    else{
+        fs::rename(temporary, entry, error);
+        if(error)
+            fs::remove(temporary, error);
+    }
+}
+
+void MeshCache::evict() const {
+
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+
+    vector<Entry> entries {};
+    uint64_t total {};
+
+    std::error_code error {};
+
+    for(fs::directory_iterator iter { this->directory, error }, end {}; !error && iter != end; iter.increment(error)){
+
+        if(iter->path().extension() != ENTRY_EXTENSION)
+            continue;
+
+        std::error_code entry_error {};
+        const uintmax_t size { iter->file_size(entry_error) };
+        const fs::file_time_type time { iter->last_write_time(entry_error) };
+
+        if(entry_error)
+            continue;
+
+        entries.push_back({ iter->path(), time, static_cast<uint64_t>(size) });
+        total += size;
+    }
+
+    if(total <= this->max_size)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &e1, const Entry &e2){
+        return e1.time < e2.time;
+    });
+
+    for(auto const& e : entries){
+
+        if(total <= this->max_size)
+            break;
+
+        if(fs::remove(e.path, error))
+            total -= e.size;
+    }
+}
@@ -1,85 +1,50 @@
 #include "textures.hpp"
 
-using std::set;
 using std::string;
 using std::shared_ptr;
 
 
-#include <iostream>
-shared_ptr<TexturesHandler> TexturesHandler::singleton { nullptr };
-
-TexturesHandler::TexturesHandler(const set<string>& texture_fns) :
-    images() {
-
-    ilInit();
-
-    const size_t num_of_images { texture_fns.size() };
-    this->images.resize(num_of_images);
-    ilGenImages(num_of_images, this->images.data());
-
-
-
-    unsigned image_count {};
-
-    for(auto const& texture_fn : texture_fns){
 
-        ilBindImage(this->images[image_count]);
-
-        if(ilLoadImage(texture_fn.c_str()) == IL_FALSE){ //bruh??
-
-            std::cerr << "\033[33;1mWarning:\033[0m Unable to load image '"
-                      << texture_fn
-                      << "'.\n";
-
-            continue;
-        }
-
-        const int width { ilGetInteger(IL_IMAGE_WIDTH) };
-        const int height { ilGetInteger(IL_IMAGE_HEIGHT) };
-
-        if(width <= 0 || height <= 0)
-            continue;
+shared_ptr<TexturesHandler> TexturesHandler::singleton { nullptr };
 
-        ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+TexturesHandler::TexturesHandler() :
+    images(), image_info() {}
 
-        ILinfo image_info {};
-        iluGetImageInfo(&image_info);
-        if(image_info.Origin == IL_ORIGIN_UPPER_LEFT)
-            iluFlipImage();
+void TexturesHandler::add_image(const string &texture_fn, LoadedImage &image){
 
+    //images which couldn't be decoded were already warned about
+    if(image.pixels.empty())
+        return;
 
-        glGenTextures(1, this->images.data() + image_count);
+    unsigned texture {};
+    glGenTextures(1, &texture);
 
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
-        glBindTexture(GL_TEXTURE_2D, this->images.at(image_count));
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGBA,
+        image.width, image.height, 0, GL_RGBA,
+        GL_UNSIGNED_BYTE, image.pixels.data()
+    );
 
-        unsigned char const* const image_data { ilGetData() };
-	    glTexImage2D(
-            GL_TEXTURE_2D, 0, GL_RGBA,
-            width, height, 0, GL_RGBA,
-            GL_UNSIGNED_BYTE, image_data
-        );
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-        this->image_info.insert( { texture_fn, image_count } );
-        ++image_count;
-    }
+    image.pixels = std::vector<unsigned char>{};
 
-    if(image_count < num_of_images){
-        ilDeleteImages(num_of_images - image_count, this->images.data() + image_count);
-        this->images.resize(image_count);
-    }
+    this->image_info.insert( { texture_fn, static_cast<unsigned>(this->images.size()) } );
+    this->images.push_back(texture);
 }
 
-void TexturesHandler::init(const std::set<std::string> &textures_fns){
+void TexturesHandler::init(){
     if(TexturesHandler::singleton == nullptr)
         TexturesHandler::singleton =
             std::make_shared<TexturesHandler>(
                 std::move<TexturesHandler>(
-                    { textures_fns }
+                    {}
                 )
             );
 }
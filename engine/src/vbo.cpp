@@ -2,19 +2,76 @@
 
 using std::string;
 using std::vector;
-using std::set;
+using std::map;
 using std::shared_ptr;
 
 
 
 shared_ptr<VBO> VBO::singleton { nullptr };
 
-VBO::VBO(const set<string> &model_fns) :
-    buffers(), model_info(), normals_info(), text_coords_info(){
+//fill buffer in with count values from data, leaving it unbound
+template<typename T>
+static void buffer_data(GLenum target, unsigned buffer, const T *data, size_t count){
+
+    glBindBuffer(target, buffer);
+    glBufferData(
+        target,
+        static_cast<long>(count * sizeof(*data)),
+        data,
+        GL_STATIC_DRAW
+    );
+    glBindBuffer(target, 0);
+}
+
+template<typename T>
+static void buffer_data(GLenum target, unsigned buffer, const vector<T> &data){
+    buffer_data(target, buffer, data.data(), data.size());
+}
+
+//draw the given ranges of indexes (or of vertexes, if not indexed) with a single call
+static void draw_ranges(const vector<std::pair<uint32_t, uint32_t>> &ranges, bool indexed){
+
+    if(ranges.empty())
+        return;
+
+    vector<GLsizei> counts {};
+    vector<GLint> firsts {};
+    vector<const void*> offsets {};
+
+    for(auto const& [first, count] : ranges){
+
+        counts.push_back(static_cast<GLsizei>(count));
+
+        if(indexed)
+            offsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(first) * sizeof(uint32_t)));
+        else
+            firsts.push_back(static_cast<GLint>(first));
+    }
+
+    if(indexed)
+        glMultiDrawElements(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), static_cast<GLsizei>(counts.size()));
+    else
+        glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(), static_cast<GLsizei>(counts.size()));
+}
+
+
+
+VBO::VBO() :
+    buffers(), model_info(), normals_info(), text_coords_info(), indexes_info(), quantized_info(), single_precision(),
+    bounds_info(), meshlets_info(){
 
     glewInit();
+}
+
+void VBO::add_model(const string &model_fn, LoadedModel &model){
+
+    if(model.code != ErrorCode::success)
+        return;
+
+    //space for normals, texture coordinates and indexes as well
+    static constexpr unsigned BUFFERS_PER_MODEL { 4 };
 
-    const size_t num_of_buffers { model_fns.size() * 3 }; //space for normals as well
+    const unsigned first_buffer { static_cast<unsigned>(this->buffers.size()) };
 
     /**
      * Reserve doesn't work as the vector merely holds enough memory for 'size' elements
@@ -31,80 +88,161 @@ VBO::VBO(const set<string> &model_fns) :
      * the newly allocated space with default constructed values
      */
 
-    this->buffers.resize(num_of_buffers);
-    glGenBuffers(num_of_buffers, this->buffers.data());
+    this->buffers.resize(first_buffer + BUFFERS_PER_MODEL);
+    glGenBuffers(BUFFERS_PER_MODEL, this->buffers.data() + first_buffer);
 
 
 
-    unsigned buffer_count {};
+    unsigned buffer_count { first_buffer };
 
-    for(auto const& model_fn : model_fns){
+    //cached models are mapped straight from their entry, which is unmapped once uploaded
+    if(model.cached.has_value()){
+        buffer_count = this->upload_cached_mesh(model_fn, model.cached.value(), buffer_count);
+        model.cached.reset();
+    }
+    else if(model.quantized){
+        buffer_count = this->upload_quantized_mesh(model_fn, model.qmesh, buffer_count);
+        model.qmesh = QuantizedMesh{};
+    }
+    else{
+        buffer_count = this->upload_mesh(model_fn, model.mesh, buffer_count);
+        model.mesh = Mesh{};
+    }
+
+    this->bounds_info.insert( { model_fn, model.bounds } );
+
+    const unsigned last_buffer { first_buffer + BUFFERS_PER_MODEL };
 
-        auto const& [code, points, normals, text_coords] { files_reader(model_fn) };
-        if(code == ErrorCode::success){
+    if(buffer_count < last_buffer){
+        glDeleteBuffers(static_cast<GLsizei>(last_buffer - buffer_count), this->buffers.data() + buffer_count);
+        this->buffers.resize(buffer_count);
+    }
+}
 
-            glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(buffer_count));
-            glBufferData(
-                GL_ARRAY_BUFFER,
-                static_cast<long>(points.size() * sizeof(*points.data())),
-                points.data(),
-                GL_STATIC_DRAW
-            );
+//upload each attribute of mesh to the buffers starting at buffer_count, returning the next free one
+unsigned VBO::upload_mesh(const string &model_fn, const Mesh &mesh, unsigned buffer_count){
 
-            this->model_info.insert( { model_fn, { buffer_count, points.size() } } );
-            ++buffer_count;
+    auto const& [points, normals, text_coords, indexes, meshlets] { mesh };
 
-            if(normals.size() > 0){
+    buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), points);
+    this->model_info.insert( { model_fn, { buffer_count, points.size() } } );
+    ++buffer_count;
 
-                glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(buffer_count));
-                glBufferData(
-                    GL_ARRAY_BUFFER,
-                    static_cast<long>(normals.size() * sizeof(*normals.data())),
-                    normals.data(),
-                    GL_STATIC_DRAW
-                );
+    if(normals.size() > 0){
+        buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), normals);
+        this->normals_info.insert( { model_fn, { buffer_count, normals.size() } } );
+        ++buffer_count;
+    }
 
-                this->normals_info.insert( { model_fn, { buffer_count, normals.size() } } );
-                ++buffer_count;
-            }
+    if(text_coords.size() > 0){
+        buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), text_coords);
+        this->text_coords_info.insert( { model_fn, { buffer_count, text_coords.size() } } );
+        ++buffer_count;
+    }
+
+    if(indexes.size() > 0){
+        buffer_data(GL_ELEMENT_ARRAY_BUFFER, this->buffers.at(buffer_count), indexes);
+        this->indexes_info.insert( { model_fn, { buffer_count, indexes.size() } } );
+        ++buffer_count;
+    }
+
+    if(meshlets.size() > 0)
+        this->meshlets_info.insert( { model_fn, meshlets } );
+
+    return buffer_count;
+}
+
+//same as upload_mesh, for a mesh whose attributes are uploaded still quantized
+unsigned VBO::upload_quantized_mesh(const string &model_fn, const QuantizedMesh &qmesh, unsigned buffer_count){
+
+    const size_t vertex_count { qmesh.vertex_count() };
+
+    buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), qmesh.positions);
+    this->model_info.insert( { model_fn, { buffer_count, vertex_count } } );
+    ++buffer_count;
 
-            if(text_coords.size() > 0){
+    if(qmesh.normals.size() > 0){
+        buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), qmesh.normals);
+        this->normals_info.insert( { model_fn, { buffer_count, vertex_count } } );
+        ++buffer_count;
+    }
+
+    if(qmesh.text_coords.size() > 0){
+        buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), qmesh.text_coords);
+        this->text_coords_info.insert( { model_fn, { buffer_count, vertex_count } } );
+        ++buffer_count;
+    }
+
+    if(qmesh.indexes.size() > 0){
+        buffer_data(GL_ELEMENT_ARRAY_BUFFER, this->buffers.at(buffer_count), qmesh.indexes);
+        this->indexes_info.insert( { model_fn, { buffer_count, qmesh.indexes.size() } } );
+        ++buffer_count;
+    }
 
-                glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(buffer_count));
-                glBufferData(
-                    GL_ARRAY_BUFFER,
-                    static_cast<long>(text_coords.size() * sizeof(*text_coords.data())),
-                    text_coords.data(),
-                    GL_STATIC_DRAW
-                );
+    if(qmesh.meshlets.size() > 0)
+        this->meshlets_info.insert( { model_fn, qmesh.meshlets } );
 
-                this->text_coords_info.insert( { model_fn, { buffer_count, text_coords.size() } } );
-                ++buffer_count;
+    this->quantized_info.insert(
+        {
+            model_fn,
+            {
+                qmesh.position_ranges,
+                qmesh.text_coord_ranges,
+                static_cast<GLenum>(qmesh.normal_bits == 8 ? GL_BYTE : GL_SHORT)
             }
         }
-    }
+    );
 
-    if(buffer_count < num_of_buffers){
-        glDeleteBuffers(num_of_buffers - buffer_count, this->buffers.data() + buffer_count);
-        this->buffers.resize(buffer_count);
+    return buffer_count;
+}
+
+//same as upload_mesh, for a mesh mapped from the cache, whose attributes are floats
+unsigned VBO::upload_cached_mesh(const string &model_fn, const CachedMesh &cached, unsigned buffer_count){
+
+    const size_t vertex_count { cached.vertex_count };
+
+    buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), cached.vertexes, 3 * vertex_count);
+    this->model_info.insert( { model_fn, { buffer_count, vertex_count } } );
+    ++buffer_count;
+
+    buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), cached.normals, 3 * vertex_count);
+    this->normals_info.insert( { model_fn, { buffer_count, vertex_count } } );
+    ++buffer_count;
+
+    buffer_data(GL_ARRAY_BUFFER, this->buffers.at(buffer_count), cached.text_coords, 2 * vertex_count);
+    this->text_coords_info.insert( { model_fn, { buffer_count, vertex_count } } );
+    ++buffer_count;
+
+    if(cached.index_count > 0){
+        buffer_data(GL_ELEMENT_ARRAY_BUFFER, this->buffers.at(buffer_count), cached.indexes, cached.index_count);
+        this->indexes_info.insert( { model_fn, { buffer_count, cached.index_count } } );
+        ++buffer_count;
     }
+
+    if(cached.meshlets.size() > 0)
+        this->meshlets_info.insert( { model_fn, cached.meshlets } );
+
+    this->single_precision.insert(model_fn);
+
+    return buffer_count;
 }
 
-void VBO::init(const std::set<std::string> &model_fns){
+void VBO::init(){
     if(VBO::singleton == nullptr)
-        VBO::singleton = std::make_shared<VBO>(std::move<VBO>( { model_fns } ));
+        VBO::singleton = std::make_shared<VBO>(std::move<VBO>( {} ));
 }
 
 shared_ptr<VBO> VBO::get_instance(){
     return VBO::singleton;
 }
 
-bool VBO::render(const string& model_fn) const {
+bool VBO::render(const string& model_fn, const Culler &culler) const {
 
     //check number of mappings for this key
     const bool has_vertexes { this->model_info.count(model_fn) > 0 };
     const bool has_normals { this->normals_info.count(model_fn) > 0 };
     const bool has_texture { this->has_texture(model_fn) };
+    const bool has_indexes { this->indexes_info.count(model_fn) > 0 };
 
     if(!has_normals)
         glDisableClientState(GL_NORMAL_ARRAY);
@@ -114,23 +252,92 @@ bool VBO::render(const string& model_fn) const {
 
     if(has_vertexes){
 
+        //quantized attributes are 16 bit integers, with positions and normals padded to 4 components
+        auto const quantized { this->quantized_info.find(model_fn) };
+        const bool is_quantized { quantized != this->quantized_info.end() };
+        const GLenum float_type { static_cast<GLenum>(this->single_precision.count(model_fn) > 0 ? GL_FLOAT : GL_DOUBLE) };
+
         auto const& [vindex, vsize] { this->model_info.at(model_fn) };
         glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(vindex));
-        glVertexPointer(3, GL_DOUBLE, 0, 0);
+
+        if(is_quantized)
+            glVertexPointer(3, GL_SHORT, 4 * sizeof(int16_t), 0);
+        else
+            glVertexPointer(3, float_type, 0, 0);
 
         if(has_normals){
             auto const& [nindex, nsize] { this->normals_info.at(model_fn) };
             glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(nindex));
-            glNormalPointer(GL_DOUBLE, 0, 0);
+
+            if(is_quantized){
+                const GLenum type { quantized->second.normal_type };
+                glNormalPointer(type, type == GL_BYTE ? 4 * sizeof(int8_t) : 4 * sizeof(int16_t), 0);
+            }
+            else
+                glNormalPointer(float_type, 0, 0);
         }
 
         if(has_texture){
             auto const& [tindex, tsize] { this->text_coords_info.at(model_fn) };
             glBindBuffer(GL_ARRAY_BUFFER, this->buffers.at(tindex));
-            glTexCoordPointer(2, GL_DOUBLE, 0, 0);
+            glTexCoordPointer(2, is_quantized ? GL_SHORT : float_type, 0, 0);
+        }
+
+        /**
+         * Each quantized value q stands for offset + q * scale,
+         * which is a translation following a scale
+         * Normals are integers mapped onto [-1, 1] by OpenGL itself and transformed
+         * by the inverse scale, which is the same along every axis (see position_ranges),
+         * so they keep their direction and are merely renormalized, as GL_NORMALIZE is enabled
+         */
+        if(is_quantized){
+
+            auto const& [pos, text, _] { quantized->second };
+
+            glPushMatrix();
+            glTranslated(pos[0].offset, pos[1].offset, pos[2].offset);
+            glScaled(pos[0].scale, pos[1].scale, pos[2].scale);
+
+            if(has_texture){
+                glMatrixMode(GL_TEXTURE);
+                glPushMatrix();
+                glTranslated(text[0].offset, text[1].offset, 0.0);
+                glScaled(text[0].scale, text[1].scale, 1.0);
+                glMatrixMode(GL_MODELVIEW);
+            }
+        }
+
+        //meshlets are culled against the group's modelview, in model coordinates (not quantized ones)
+        auto const meshlets { this->meshlets_info.find(model_fn) };
+        const bool has_meshlets { meshlets != this->meshlets_info.end() };
+
+        if(has_indexes){
+            auto const& [iindex, isize] { this->indexes_info.at(model_fn) };
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.at(iindex));
+
+            if(has_meshlets)
+                draw_ranges(culler.visible_ranges(meshlets->second), true);
+            else
+                glDrawElements(GL_TRIANGLES, static_cast<int>(isize), GL_UNSIGNED_INT, 0);
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }
+        else if(has_meshlets)
+            draw_ranges(culler.visible_ranges(meshlets->second), false);
+        else
+            glDrawArrays(GL_TRIANGLES, 0, vsize);
+
+        if(is_quantized){
+
+            if(has_texture){
+                glMatrixMode(GL_TEXTURE);
+                glPopMatrix();
+                glMatrixMode(GL_MODELVIEW);
+            }
+
+            glPopMatrix();
         }
 
-        glDrawArrays(GL_TRIANGLES, 0, vsize);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
@@ -143,6 +350,14 @@ bool VBO::render(const string& model_fn) const {
     return has_vertexes;
 }
 
+//bounds of the model in its own coordinates, or nullptr if it wasn't loaded
+const Bounds* VBO::get_bounds(const string &model_fn) const {
+
+    auto const iter { this->bounds_info.find(model_fn) };
+
+    return iter != this->bounds_info.end() ? &iter->second : nullptr;
+}
+
 bool VBO::has_texture(const string &model_fn) const {
     return this->text_coords_info.count(model_fn) > 0;
 }
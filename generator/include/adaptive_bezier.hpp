@@ -0,0 +1,25 @@
+#ifndef ADAPTIVE_BEZIER_HPP
+#define ADAPTIVE_BEZIER_HPP
+
+#include <array>
+
+#include "point.hpp"
+#include "mesh.hpp"
+#include "bernstein.hpp"
+
+
+/**
+ * Tesselate a patch with as many segments as needed for the surface to be within
+ * tolerance of its triangles (chordal deviation), up to max_level segments per side
+ *
+ * Segment counts come from the second differences of the control points, which bound
+ * the second derivative of the surface. Each of the four edges gets its own count,
+ * which only depends on that edge's control points: a neighbouring patch sharing
+ * the edge thus samples it at the very same points and no cracks show.
+ * The interior grid, as fine as the most curved row (or column) demands, is stitched
+ * to each edge by a strip of triangles.
+ */
+void tesselate_adaptive_patch(Mesh &mesh, const std::array<CartPoint3d, NUM_OF_PATCH_POINTS> &points,
+                              double tolerance, unsigned max_level);
+
+#endif
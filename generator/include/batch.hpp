@@ -0,0 +1,29 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <string>
+
+#include "error_code.hpp"
+#include "options.hpp"
+
+
+/**
+ * Generate every primitive listed in a manifest file in a single run
+ *
+ * Each line holds the arguments of one generator invocation, e.g.
+ *      sphere 1 10 10 sphere.3d
+ *      --binary bezier teapot.patch 10 teapot.3d
+ * Empty lines and lines starting with '#' are skipped. Options given on the command line
+ * apply to every line, on top of which each line may add its own.
+ * Relative paths are relative to the working directory, as on the command line.
+ *
+ * Jobs are spread among --threads workers (one per core by default), each job
+ * being generated by a single thread unless its own line says otherwise.
+ * Lines writing the same file are rejected, while a line reading a file another one
+ * writes runs only once the earlier of the two in the manifest is done.
+ * A summary with the time taken by each job is printed at the end.
+ */
+ErrorCode batch_writer(const std::string &program, const std::string &manifest_fn,
+                       const Options &options);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef BERNSTEIN_HPP
+#define BERNSTEIN_HPP
+
+#include <array>
+#include <vector>
+
+#include "point.hpp"
+
+
+static constexpr size_t NUM_OF_PATCH_POINTS { 16 };
+
+
+/**
+ * Values of the four cubic Bernstein polynomials (and of their derivatives)
+ * at every sample of [0, 1], which only depend on the tesselation level
+ * and are thus computed once per run
+ *
+ * basis[k][s] holds the k-th polynomial at sample s, so that a whole row of samples
+ * is evaluated by streaming through contiguous memory. Rows are padded with zeros
+ * up to a multiple of the SIMD width.
+ */
+class BernsteinTable {
+
+private:
+    size_t samples;
+    size_t padded_samples;
+    double time_step;
+
+    std::array<std::vector<double>, 4> basis;
+    std::array<std::vector<double>, 4> deriv;
+
+public:
+    BernsteinTable(size_t samples, double time_step);
+
+    size_t size() const;
+    size_t padded_size() const;
+    double time_at(size_t s) const;
+
+    double basis_at(size_t k, size_t s) const;
+    double deriv_at(size_t k, size_t s) const;
+
+    const double* basis_row(size_t k) const;
+    const double* deriv_row(size_t k) const;
+};
+
+
+/**
+ * Positions and normals of a row of samples of a patch,
+ * as separate x, y and z arrays
+ */
+class PatchRow {
+
+private:
+    std::array<std::vector<double>, 3> positions;
+    std::array<std::vector<double>, 3> normals;
+
+public:
+    PatchRow(const BernsteinTable &table);
+
+    CartPoint3d position(size_t s) const;
+    CartPoint3d normal(size_t s) const;
+
+    friend void evaluate_patch_row(const std::array<CartPoint3d, NUM_OF_PATCH_POINTS> &ctrl_points,
+                                   const BernsteinTable &table, size_t u, PatchRow &row);
+};
+
+void evaluate_patch_row(const std::array<CartPoint3d, NUM_OF_PATCH_POINTS> &ctrl_points,
+                        const BernsteinTable &table, size_t u, PatchRow &row);
+
+#endif
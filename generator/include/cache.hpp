@@ -0,0 +1,43 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "error_code.hpp"
+#include "options.hpp"
+
+
+/**
+ * Bumped whenever a change to the generator alters its output for the same arguments,
+ * so that files written by older versions are no longer considered up to date
+ */
+static constexpr uint32_t GENERATOR_VERSION { 12 };
+
+
+/**
+ * Outputs are regenerated only when their inputs change
+ *
+ * The hash of everything a run depends on (generator version, primitive type and
+ * arguments, options affecting the output and the contents of every input file) is
+ * recorded in a .hash file next to the output once it is successfully written.
+ * args are the positional arguments, starting with the program name,
+ * the output file being the last one.
+ */
+uint64_t generation_hash(const std::vector<std::string> &args, const Options &options);
+
+//files making up the output out_fn, as written with the given options (its .hash aside)
+std::vector<std::string> output_files(const std::string &out_fn, const Options &options);
+
+/**
+ * Files a run may read, whether they exist yet or not: every argument other than
+ * the output, along with the normals and texture coordinates of text model inputs
+ */
+std::vector<std::string> input_files(const std::vector<std::string> &args);
+
+bool is_up_to_date(const std::string &out_fn, const Options &options, uint64_t hash);
+ErrorCode record_hash(const std::string &out_fn, uint64_t hash);
+void forget_hash(const std::string &out_fn);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef LOD_HPP
+#define LOD_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "error_code.hpp"
+#include "options.hpp"
+
+
+/**
+ * Write options.lods levels of detail of the primitive described by args
+ * (the positional arguments, starting with the program name)
+ *
+ * Level 0 is the primitive as requested and goes to the given output file.
+ * Each following level scales the primitive's resolution arguments (slices, stacks,
+ * divisions, grid size or tesselation level) by 1/sqrt(2), and so has about half the
+ * triangles of the previous one. It is written to a sibling file, e.g. sphere_lod1.3d.
+ * The chain stops early once the resolution can't be lowered any further.
+ *
+ * The levels and their triangle counts are listed in a .lods file next to the output,
+ * one "<level> <triangles> <file>" line per level.
+ */
+ErrorCode lod_writer(const std::vector<std::string> &args, const Options &options);
+
+//sphere.3d -> sphere_lod1.3d, level 0 being fn itself
+std::string lod_filename(const std::string &fn, unsigned level);
+
+//sphere.3d -> sphere.lods, listing the levels written to sphere.3d and its siblings
+std::string lods_filename(const std::string &fn);
+
+//list the levels written to out_fn and its siblings, triangles[l] being the count of level l
+ErrorCode write_lods_file(const std::string &out_fn, const std::vector<uint64_t> &triangles);
+
+#endif
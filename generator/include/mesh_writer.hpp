@@ -0,0 +1,44 @@
+#ifndef MESH_WRITER_HPP
+#define MESH_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "error_code.hpp"
+#include "point.hpp"
+#include "mesh.hpp"
+#include "text_writer.hpp"
+#include "filters.hpp"
+#include "options.hpp"
+
+
+/**
+ * Append points to one of the mesh's buffers with the same syntax
+ * used to write them to a file
+ * Defined inline as they sit in the innermost loop of every writer
+ */
+inline std::vector<CartPoint3d>& operator<<(std::vector<CartPoint3d> &v, const CartPoint3d &p){
+    v.push_back(p);
+    return v;
+}
+
+inline std::vector<CartPoint3d>& operator<<(std::vector<CartPoint3d> &v, const PolarPoint3d &p){
+    v.push_back(polar_to_cart(p));
+    return v;
+}
+
+inline std::vector<CartPoint2d>& operator<<(std::vector<CartPoint2d> &v, const CartPoint2d &p){
+    v.push_back(p);
+    return v;
+}
+
+inline std::vector<CartPoint2d>& operator<<(std::vector<CartPoint2d> &v, const PolarPoint2d &p){
+    v.push_back(polar_to_cart(p));
+    return v;
+}
+
+ErrorCode binary_writer(const std::string &filename, const Mesh &mesh, const Options &options);
+ErrorCode write_mesh(const std::string &filename, Mesh &mesh, const Options &options);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef MESHLETS_HPP
+#define MESHLETS_HPP
+
+#include <cstddef>
+
+#include "mesh.hpp"
+
+
+/**
+ * Partition the triangles of an indexed mesh into meshlets of at most max_vertexes
+ * distinct vertexes and max_triangles triangles, for the engine to cull each one on its own
+ *
+ * Meshlets are grown greedily from a seed triangle, always adding the neighbouring
+ * triangle that brings in the fewest new vertexes and, among those, the one closest
+ * to the meshlet, so that meshlets are compact and their spheres and normal cones tight.
+ * The indexes are reordered so that the triangles of each meshlet are consecutive,
+ * and only the ranges of mesh.meshlets are set (see Meshlet).
+ */
+void build_meshlets(Mesh &mesh, size_t max_vertexes, size_t max_triangles);
+
+#endif
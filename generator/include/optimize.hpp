@@ -0,0 +1,47 @@
+#ifndef OPTIMIZE_HPP
+#define OPTIMIZE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "error_code.hpp"
+#include "mesh.hpp"
+#include "options.hpp"
+
+
+/**
+ * Rewrite an existing mesh (binary or a .3d/.norm/.text triplet) for faster drawing:
+ * equal vertexes are welded, triangles are reordered for the post-transform vertex cache
+ * and, with --overdraw, clusters of triangles are sorted to draw outer-facing ones first.
+ * Vertexes are then laid out in the order they are first used.
+ * The result is always written as an indexed binary mesh.
+ *
+ * Cache statistics before and after each step are printed.
+ */
+ErrorCode optimize_writer(const std::string &in_fn, const std::string &out_fn, const Options &options);
+
+
+//size of the FIFO vertex cache both optimized for and simulated in the statistics
+static constexpr size_t VERTEX_CACHE_SIZE { 32 };
+
+/**
+ * Average cache miss ratio (transformed vertexes per triangle) and
+ * average transformed vertex ratio (transformed vertexes per vertex)
+ * of drawing indexes with a FIFO cache of cache_size entries
+ */
+struct CacheStats {
+    double acmr;
+    double atvr;
+
+    CacheStats();
+};
+
+CacheStats cache_stats(const std::vector<uint32_t> &indexes, size_t vertex_count,
+                       size_t cache_size = VERTEX_CACHE_SIZE);
+
+std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t> &indexes, size_t vertex_count);
+std::vector<uint32_t> optimize_overdraw(const std::vector<uint32_t> &indexes, const Mesh &mesh);
+void optimize_vertex_fetch(Mesh &mesh);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <string>
+#include <vector>
+#include <tuple>
+
+#include "error_code.hpp"
+
+
+/**
+ * Settings given through '--' prefixed arguments,
+ * which may appear anywhere in the command line
+ */
+struct Options {
+    bool binary;
+    bool single_precision;
+    bool indexed;
+    unsigned threads;   //0 stands for one per hardware thread
+    bool force;         //regenerate even if the output is up to date
+    unsigned lods;      //number of levels of detail to write
+    double tolerance;   //maximum chordal deviation of adaptive bezier tesselation, 0 if uniform
+    bool overdraw;      //have optimize also sort triangles to reduce overdraw
+    unsigned quantize;  //bits of each octahedral normal component if quantized, 0 otherwise
+    unsigned memory;    //memory budget in MiB of streaming generation, 0 to generate whole meshes
+    unsigned meshlet_vertexes;  //limits of each meshlet, 0 if the mesh isn't split into meshlets
+    unsigned meshlet_triangles;
+    double max_error;   //distance simplify may stray from the input, 0 for no limit
+
+    Options();
+};
+
+std::tuple<ErrorCode, Options, std::vector<std::string>>
+parse_options(int size, const std::string args[], Options options = Options{});
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "mesh.hpp"
+
+
+/**
+ * Generates a mesh made up of count work units (patches, slices, rows...)
+ * Each worker is given a contiguous range [begin, end) of units and fills
+ * its own mesh, which are then concatenated in range order. Thus, as long as
+ * the units are independent, the result is the same as that of a single thread.
+ * A thread count of 0 means one per hardware thread.
+ */
+using RangeGenerator = std::function<void(Mesh &mesh, size_t begin, size_t end)>;
+
+Mesh generate_parallel(size_t count, unsigned threads, const RangeGenerator &generate);
+
+unsigned default_thread_count();
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PATCH_READER_HPP
+#define PATCH_READER_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <tuple>
+
+#include "error_code.hpp"
+#include "point.hpp"
+#include "bernstein.hpp"
+
+
+/**
+ * Read a .patch file: the number of patches, then one line per patch with the
+ * NUM_OF_PATCH_POINTS comma separated indexes of its control points,
+ * then the number of control points, then each one as "x, y, z"
+ *
+ * The file is parsed in place, straight from memory. If it is malformed,
+ * the line and column at fault are printed along with what was expected there.
+ */
+std::tuple<ErrorCode, std::vector<std::array<unsigned, NUM_OF_PATCH_POINTS>>, std::vector<CartPoint3d>>
+read_patch_file(const std::string &filename);
+
+#endif
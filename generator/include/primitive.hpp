@@ -13,8 +13,10 @@
 #include "point.hpp"
 #include "matrix.hpp"
 #include "filters.hpp"
+#include "options.hpp"
 
 
-ErrorCode primitive_writer(int size, const std::string args[]);
+ErrorCode primitive_writer(int argc, const std::string argv[]);
+ErrorCode primitive_writer(const std::vector<std::string> &args, const Options &options);
 
 #endif
@@ -0,0 +1,95 @@
+#ifndef SIMPLIFY_HPP
+#define SIMPLIFY_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "error_code.hpp"
+#include "mesh.hpp"
+#include "options.hpp"
+
+
+/**
+ * Reduce an existing mesh (binary or a .3d/.norm/.text triplet) to about target triangles,
+ * stopping early if that would stray more than options.max_error from the input.
+ * With options.lods, the simplification carries on to write coarser levels,
+ * each with about half the triangles of the previous one and twice the error allowed,
+ * to siblings of the output file listed in a .lods file, as in lod_writer.
+ *
+ * The error and triangle count of each level are printed.
+ */
+ErrorCode simplify_writer(const std::string &in_fn, size_t target, const std::string &out_fn,
+                          const Options &options);
+
+
+/**
+ * Sum of the squared distances to a set of weighted planes, p·Ap + 2b·p + c
+ * area is the total area of the triangles the planes come from, so that errors are averages
+ */
+struct Quadric {
+    std::array<double, 6> a;    //a00, a11, a22, a01, a02, a12
+    std::array<double, 3> b;
+    double c;
+    double area;
+
+    Quadric();
+    Quadric(const CartPoint3d &normal, double distance, double weight);
+
+    Quadric& operator+=(const Quadric &q);
+    double error(const CartPoint3d &p) const;
+};
+
+enum class VertexKind {
+    free,       //inside a surface, with a single normal and texture coordinate
+    border,     //on the single open edge chain through it
+    seam,       //on the single chain of edges along which normals or texture coordinates change
+    locked,     //anywhere else: corners, where chains meet and non manifold vertexes
+};
+
+/**
+ * Quadric error metric edge collapse (Garland and Heckbert), over a welded indexed mesh
+ *
+ * Each collapse moves every triangle corner at a position onto a neighbouring one,
+ * whose normal and texture coordinates are kept as is, and costs the error of
+ * that position against the planes of every triangle merged into the two.
+ * Vertexes on borders and seams only ever move along them, so that neither
+ * open edges nor normal creases and texture seams are torn apart or moved off their line,
+ * and corners never move at all. Collapses that would fold a triangle over, or turn it
+ * away from the input surface at any of its corners, are skipped.
+ *
+ * Collapses are done in passes, cheapest first and touching each position once per pass,
+ * so that simplify can be called again to carry on to a coarser level.
+ */
+class Simplifier {
+
+private:
+    Mesh mesh;
+    std::vector<uint32_t> indexes;          //the triangles left, as vertexes of mesh
+    std::vector<uint32_t> position;         //the vertex standing for the position of each vertex
+    std::vector<uint32_t> next_vertex;      //circular list of the vertexes sharing each position
+    std::vector<VertexKind> kinds;          //per position
+    std::vector<Quadric> quadrics;          //per position
+    std::vector<CartPoint3d> surface_normals;   //per position, averaged over the input triangles around it
+    double max_collapse_error;
+
+    void classify();
+    size_t collapse_pass(size_t target, double error_limit);
+
+public:
+    Simplifier(Mesh &&welded);
+
+    size_t triangle_count() const;
+
+    //largest error of a collapse so far, as a distance
+    double error() const;
+
+    //collapse edges until at most target triangles are left or every collapse strays more than max_error
+    void simplify(size_t target, double max_error);
+
+    //the triangles left and the vertexes they use
+    Mesh result() const;
+};
+
+#endif
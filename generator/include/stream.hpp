@@ -0,0 +1,38 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <string>
+
+#include "error_code.hpp"
+#include "mesh.hpp"
+#include "options.hpp"
+#include "parallel.hpp"
+
+
+/**
+ * Generate the count work units of a mesh and write it to filename,
+ * either all at once or, if options.memory is set, a tile of units at a time
+ */
+ErrorCode generate_mesh(const std::string &filename, size_t count, const Options &options,
+                        const RangeGenerator &generate);
+
+/**
+ * Generate the count work units of a mesh in tiles of consecutive units, each one
+ * written out before the next is generated, so that memory stays within about
+ * options.memory MiB regardless of the size of the mesh. Tiles are sized from
+ * the average number of vertexes per unit seen so far, and never hold less than a unit.
+ * Part of the budget is set aside for the output of a tile to be written
+ * on a thread of its own while the next one is generated.
+ *
+ * The output is the same as that of generating the whole mesh at once, except that
+ * indexed output is welded within each tile, so vertexes on tile seams are repeated.
+ * Quantized output needs the bounds of the whole mesh, and text output the box its sphere
+ * is centred on, so their tiles are set aside on disk as they are generated, next to the
+ * output, and only written out once all of them are.
+ *
+ * The number of tiles and the peak resident set size are reported once done.
+ */
+ErrorCode stream_writer(const std::string &filename, size_t count, const Options &options,
+                        const RangeGenerator &generate);
+
+#endif
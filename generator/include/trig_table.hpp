@@ -0,0 +1,28 @@
+#ifndef TRIG_TABLE_HPP
+#define TRIG_TABLE_HPP
+
+#include <vector>
+
+#include "point.hpp"
+
+
+/**
+ * Sines and cosines of the angles start + i * step (in degrees), for i in [0, count]
+ *
+ * The angles writers sample only depend on the slice or stack, so these are computed
+ * once per run and shared by positions, normals and texture coordinates
+ */
+class TrigTable {
+
+private:
+    std::vector<double> sines;
+    std::vector<double> cosines;
+
+public:
+    TrigTable(size_t count, angle_t start, angle_t step);
+
+    double sin(size_t i) const;
+    double cos(size_t i) const;
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "adaptive_bezier.hpp"
+#include "mesh_writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+using std::array;
+using std::vector;
+
+
+
+//a sample of the patch, along with its parameters
+struct PatchSample {
+    CartPoint3d position;
+    CartPoint3d normal;
+    CartPoint2d params;     //(u, v)
+};
+
+using Curve = array<CartPoint3d, 4>;
+
+//P(a, k) is points[4 * a + k], a going along u and k along v
+static CartPoint3d ctrl_point(const array<CartPoint3d, NUM_OF_PATCH_POINTS> &points, size_t a, size_t k){
+    return points[4 * a + k];
+}
+
+static Curve u_curve(const array<CartPoint3d, NUM_OF_PATCH_POINTS> &points, size_t k){
+    return { ctrl_point(points, 0, k), ctrl_point(points, 1, k), ctrl_point(points, 2, k), ctrl_point(points, 3, k) };
+}
+
+static Curve v_curve(const array<CartPoint3d, NUM_OF_PATCH_POINTS> &points, size_t a){
+    return { ctrl_point(points, a, 0), ctrl_point(points, a, 1), ctrl_point(points, a, 2), ctrl_point(points, a, 3) };
+}
+
+
+
+static void bernstein(double t, array<double, 4> &basis, array<double, 4> &deriv){
+
+    const double it { 1.0 - t };
+
+    basis = { it * it * it, 3.0 * t * it * it, 3.0 * t * t * it, t * t * t };
+    deriv = {
+        -3.0 * it * it,
+        3.0 * it * it - 6.0 * t * it,
+        6.0 * t * it - 3.0 * t * t,
+        3.0 * t * t
+    };
+}
+
+static CartPoint3d evaluate_curve(const Curve &curve, double t){
+
+    array<double, 4> basis {}, deriv {};
+    bernstein(t, basis, deriv);
+
+    CartPoint3d p {};
+    for(size_t k{}; k < 4; ++k){
+        p.x += basis[k] * curve[k].x;
+        p.y += basis[k] * curve[k].y;
+        p.z += basis[k] * curve[k].z;
+    }
+
+    return p;
+}
+
+//same normal as the uniform tesselation: dv x du, normalized unless it is null
+static PatchSample evaluate_patch(const array<CartPoint3d, NUM_OF_PATCH_POINTS> &points, double u, double v){
+
+    array<double, 4> bu {}, dbu {}, bv {}, dbv {};
+    bernstein(u, bu, dbu);
+    bernstein(v, bv, dbv);
+
+    CartPoint3d pos {}, du {}, dv {};
+
+    for(size_t a{}; a < 4; ++a)
+        for(size_t k{}; k < 4; ++k){
+
+            const CartPoint3d &p { ctrl_point(points, a, k) };
+
+            pos.x += bu[a] * bv[k] * p.x;
+            pos.y += bu[a] * bv[k] * p.y;
+            pos.z += bu[a] * bv[k] * p.z;
+
+            du.x += dbu[a] * bv[k] * p.x;
+            du.y += dbu[a] * bv[k] * p.y;
+            du.z += dbu[a] * bv[k] * p.z;
+
+            dv.x += bu[a] * dbv[k] * p.x;
+            dv.y += bu[a] * dbv[k] * p.y;
+            dv.z += bu[a] * dbv[k] * p.z;
+        }
+
+    CartPoint3d n {
+        dv.y * du.z - dv.z * du.y,
+        dv.z * du.x - dv.x * du.z,
+        dv.x * du.y - dv.y * du.x
+    };
+
+    const double norm { std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z) };
+    if(norm != 0.0)
+        n = { n.x / norm, n.y / norm, n.z / norm };
+
+    return { pos, n, { u, v } };
+}
+
+
+
+static double second_difference(const CartPoint3d &p0, const CartPoint3d &p1, const CartPoint3d &p2){
+
+    const double x { p0.x - 2.0 * p1.x + p2.x };
+    const double y { p0.y - 2.0 * p1.y + p2.y };
+    const double z { p0.z - 2.0 * p1.z + p2.z };
+
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+/**
+ * Segments needed for a chord of the curve to deviate at most tolerance from it
+ * A curve whose second derivative is at most M strays at most M / (8 n^2) from the chords
+ * of n uniform segments, and for a cubic M <= 6 * max(|P0 - 2 P1 + P2|, |P1 - 2 P2 + P3|)
+ * Reversing the curve yields the same count.
+ */
+static unsigned curve_segments(const Curve &curve, double tolerance, unsigned max_level){
+
+    const double max_diff {
+        std::max(
+            second_difference(curve[0], curve[1], curve[2]),
+            second_difference(curve[1], curve[2], curve[3])
+        )
+    };
+
+    const double segments { std::ceil(std::sqrt(0.75 * max_diff / tolerance)) };
+
+    return static_cast<unsigned>(std::clamp(segments, 1.0, static_cast<double>(max_level)));
+}
+
+static bool lexicographic_less(const CartPoint3d &a, const CartPoint3d &b){
+    return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+}
+
+/**
+ * Position of the j-th of the segments + 1 samples of an edge
+ * Patches may run along a shared edge in opposite directions, so the edge is always
+ * evaluated in the same (canonical) direction, for both to get bitwise equal points
+ */
+static CartPoint3d edge_point(const Curve &edge, unsigned segments, unsigned j){
+
+    if(lexicographic_less(edge[3], edge[0])){
+
+        const Curve reversed { edge[3], edge[2], edge[1], edge[0] };
+        return evaluate_curve(reversed, static_cast<double>(segments - j) / static_cast<double>(segments));
+    }
+
+    return evaluate_curve(edge, static_cast<double>(j) / static_cast<double>(segments));
+}
+
+
+
+//emit the triangle with the same winding as the uniform tesselation, i.e. clockwise in (u, v)
+static void emit_triangle(Mesh &mesh, const PatchSample &s1, const PatchSample &s2, const PatchSample &s3){
+
+    const double area {
+        (s2.params.x - s1.params.x) * (s3.params.y - s1.params.y) -
+        (s2.params.y - s1.params.y) * (s3.params.x - s1.params.x)
+    };
+
+    const PatchSample &b { area > 0.0 ? s3 : s2 };
+    const PatchSample &c { area > 0.0 ? s2 : s3 };
+
+    mesh.vertexes << s1.position << b.position << c.position;
+    mesh.normals << s1.normal << b.normal << c.normal;
+    mesh.text_coords << s1.params << b.params << c.params;
+}
+
+/**
+ * Zip an edge (outer, sampled at i / outer_segments) and the nearest row of the
+ * interior grid (inner, sampled at i / inner_segments for 0 < i < inner_segments)
+ * into a strip of triangles, always advancing along whichever row lags behind
+ */
+static void stitch(Mesh &mesh, const vector<PatchSample> &outer, const vector<PatchSample> &inner,
+                   size_t inner_segments){
+
+    const size_t outer_segments { outer.size() - 1 };
+
+    size_t a {}, b {};
+
+    while(a < outer_segments || b + 1 < inner.size()){
+
+        //(a + 1) / outer_segments <= (b + 2) / inner_segments, without rounding
+        const bool advance_outer {
+            b + 1 == inner.size() ||
+            (a < outer_segments && (a + 1) * inner_segments <= (b + 2) * outer_segments)
+        };
+
+        if(advance_outer){
+            emit_triangle(mesh, outer[a], inner[b], outer[a + 1]);
+            ++a;
+        }
+        else{
+            emit_triangle(mesh, outer[a], inner[b], inner[b + 1]);
+            ++b;
+        }
+    }
+}
+
+
+
+void tesselate_adaptive_patch(Mesh &mesh, const array<CartPoint3d, NUM_OF_PATCH_POINTS> &points,
+                              double tolerance, unsigned max_level){
+
+    //u = 0, u = 1, v = 0 and v = 1
+    const array<Curve, 4> edges { v_curve(points, 0), v_curve(points, 3), u_curve(points, 0), u_curve(points, 3) };
+
+    array<unsigned, 4> edge_segments {};
+    for(size_t e{}; e < 4; ++e)
+        edge_segments[e] = curve_segments(edges[e], tolerance, max_level);
+
+    //the interior needs at least a sample of its own
+    unsigned u_segments { 2 }, v_segments { 2 };
+    for(size_t i{}; i < 4; ++i){
+        u_segments = std::max(u_segments, curve_segments(u_curve(points, i), tolerance, max_level));
+        v_segments = std::max(v_segments, curve_segments(v_curve(points, i), tolerance, max_level));
+    }
+
+    const auto u_at { [u_segments](size_t i){ return static_cast<double>(i) / u_segments; } };
+    const auto v_at { [v_segments](size_t j){ return static_cast<double>(j) / v_segments; } };
+
+
+
+    //interior samples, i.e. (i / u_segments, j / v_segments) for 0 < i < u_segments, 0 < j < v_segments
+    const size_t rows { u_segments - 1 };
+    const size_t cols { v_segments - 1 };
+
+    vector<PatchSample> grid {};
+    grid.reserve(rows * cols);
+
+    for(size_t i{}; i < rows; ++i)
+        for(size_t j{}; j < cols; ++j)
+            grid.push_back(evaluate_patch(points, u_at(i + 1), v_at(j + 1)));
+
+    for(size_t i{}; i + 1 < rows; ++i)
+        for(size_t j{}; j + 1 < cols; ++j){
+
+            const PatchSample &s1 { grid[i * cols + j] };
+            const PatchSample &s2 { grid[i * cols + j + 1] };
+            const PatchSample &s3 { grid[(i + 1) * cols + j] };
+            const PatchSample &s4 { grid[(i + 1) * cols + j + 1] };
+
+            emit_triangle(mesh, s1, s2, s3);
+            emit_triangle(mesh, s4, s3, s2);
+        }
+
+
+
+    for(size_t e{}; e < 4; ++e){
+
+        const bool along_v { e < 2 };
+        const unsigned segments { edge_segments[e] };
+
+        //samples of the edge, whose normals still come from the surface
+        vector<PatchSample> outer {};
+        for(unsigned j{}; j <= segments; ++j){
+
+            const double t { static_cast<double>(j) / segments };
+            const double fixed { (e % 2 == 0) ? 0.0 : 1.0 };
+
+            PatchSample s { along_v ? evaluate_patch(points, fixed, t) : evaluate_patch(points, t, fixed) };
+            s.position = edge_point(edges[e], segments, j);
+
+            outer.push_back(s);
+        }
+
+        //the row (or column) of the interior grid closest to the edge
+        vector<PatchSample> inner {};
+        if(along_v){
+            const size_t i { e == 0 ? 0 : rows - 1 };
+            for(size_t j{}; j < cols; ++j)
+                inner.push_back(grid[i * cols + j]);
+        }
+        else{
+            const size_t j { e == 2 ? 0 : cols - 1 };
+            for(size_t i{}; i < rows; ++i)
+                inner.push_back(grid[i * cols + j]);
+        }
+
+        stitch(mesh, outer, inner, along_v ? v_segments : u_segments);
+    }
+}
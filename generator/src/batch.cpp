@@ -0,0 +1,352 @@
+#include "batch.hpp"
+#include "primitive.hpp"
+#include "parallel.hpp"
+#include "cache.hpp"
+#include "lod.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+using std::string;
+using std::vector;
+using std::tuple;
+
+
+
+struct BatchJob {
+    size_t line;
+    string command;
+    Options options;
+    vector<string> args;
+
+    std::set<string> inputs;
+    std::set<string> outputs;
+    vector<size_t> after;   //earlier jobs which must be done before this one starts
+
+    ErrorCode result;
+    double elapsed_ms;
+
+    BatchJob(size_t line, const string &command);
+};
+
+BatchJob::BatchJob(size_t line, const string &command) :
+    line(line), command(command), options(), args(),
+    inputs(), outputs(), after(),
+    result(ErrorCode::success), elapsed_ms(0.0) {}
+
+
+
+static const char* error_name(ErrorCode e){
+
+    switch(e){
+
+    case ErrorCode::success:
+        return "ok";
+
+    case ErrorCode::not_enough_args:
+        return "missing arguments";
+
+    case ErrorCode::invalid_argument:
+        return "invalid argument";
+
+    case ErrorCode::io_error:
+        return "I/O error";
+
+    case ErrorCode::invalid_file_formatting:
+        return "invalid patch";
+
+    case ErrorCode::invalid_file_extension:
+        return "invalid extension";
+
+    case ErrorCode::index_overflow:
+        return "index overflow";
+
+    default:
+        return "error";
+    }
+}
+
+//trim the line and drop it if it is empty or a comment
+static string strip_line(const string &line){
+
+    const size_t begin { line.find_first_not_of(" \t\r") };
+
+    if(begin == string::npos || line[begin] == '#')
+        return "";
+
+    const size_t end { line.find_last_not_of(" \t\r") };
+
+    return line.substr(begin, end - begin + 1);
+}
+
+static tuple<ErrorCode, vector<BatchJob>>
+read_manifest(const string &program, const string &manifest_fn, const Options &options){
+
+    vector<BatchJob> jobs {};
+
+    std::ifstream manifest{};
+    manifest.open(manifest_fn, std::ios::in);
+
+    if(!manifest.is_open())
+        return { ErrorCode::io_error, std::move(jobs) };
+
+    /**
+     * Jobs get as many threads as the workers they run on (i.e. one),
+     * unless their own line asks for more
+     */
+    Options job_defaults { options };
+    job_defaults.threads = 1;
+
+    string line {};
+
+    for(size_t line_num { 1 }; std::getline(manifest, line); ++line_num){
+
+        const string command { strip_line(line) };
+        if(command == "")
+            continue;
+
+        BatchJob job { line_num, command };
+
+        vector<string> tokens { program };
+
+        std::istringstream stream { command };
+        for(string token {}; stream >> token;)
+            tokens.push_back(token);
+
+        auto&& [code, job_options, args] {
+            parse_options(static_cast<int>(tokens.size()), tokens.data(), job_defaults)
+        };
+
+        job.result = code;
+        job.options = job_options;
+        job.args = std::move(args);
+
+        jobs.push_back(std::move(job));
+    }
+
+    return { ErrorCode::success, std::move(jobs) };
+}
+
+/**
+ * Every file the job writes: the output file (always the last argument) along with
+ * its sidecars and cache hash, those of its coarser levels of detail and their .lods list
+ */
+static std::set<string> job_outputs(const BatchJob &job){
+
+    if(job.result != ErrorCode::success || job.args.size() < 2)
+        return {};
+
+    const string &out_fn { job.args.back() };
+
+    //anything else is rejected by primitive_writer before it writes a thing
+    if(!has_3d_ext(out_fn))
+        return { out_fn };
+
+    Options options { job.options };
+
+    //as primitive_writer does
+    if(job.args[1] == "optimize")
+        options.binary = true;
+
+    std::set<string> outputs {};
+    const unsigned levels { std::max(options.lods, 1U) };
+
+    for(unsigned level{}; level < levels; ++level){
+
+        const string level_fn { lod_filename(out_fn, level) };
+
+        for(auto const& fn : output_files(level_fn, options))
+            outputs.insert(fn);
+
+        outputs.insert(to_hash_extension(level_fn));
+    }
+
+    if(levels > 1)
+        outputs.insert(lods_filename(out_fn));
+
+    return outputs;
+}
+
+static std::set<string> job_inputs(const BatchJob &job){
+
+    if(job.result != ErrorCode::success)
+        return {};
+
+    const vector<string> inputs { input_files(job.args) };
+
+    return { inputs.begin(), inputs.end() };
+}
+
+static bool share_any(const std::set<string> &a, const std::set<string> &b){
+
+    for(auto const& fn : a)
+        if(b.count(fn) > 0)
+            return true;
+
+    return false;
+}
+
+/**
+ * Jobs run concurrently, so two of them writing the same file would clobber each other
+ * Each clashing pair of lines is reported once, however many files they both write
+ */
+static bool has_duplicate_outputs(const vector<BatchJob> &jobs){
+
+    std::map<string, size_t> writers {};
+    bool found { false };
+
+    for(auto const& job : jobs){
+
+        std::set<size_t> reported {};
+
+        for(auto const& fn : job.outputs){
+
+            auto const& [iter, inserted] { writers.try_emplace(fn, job.line) };
+
+            if(!inserted && reported.insert(iter->second).second){
+                std::cerr << "generator: line " << job.line << " writes " << fn
+                          << ", which is also written by line " << iter->second << '\n';
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * A job reading a file another one writes, e.g. optimizing a generated model, must not
+ * run alongside it, so whichever of the two comes later in the manifest waits for the other
+ */
+static void order_dependent_jobs(vector<BatchJob> &jobs){
+
+    for(size_t j{}; j < jobs.size(); ++j)
+        for(size_t i{}; i < j; ++i)
+            if(share_any(jobs[i].outputs, jobs[j].inputs) || share_any(jobs[i].inputs, jobs[j].outputs))
+                jobs[j].after.push_back(i);
+}
+
+static void run_job(BatchJob &job){
+
+    if(job.result != ErrorCode::success)
+        return;
+
+    const auto begin_time { std::chrono::steady_clock::now() };
+
+    job.result = primitive_writer(job.args, job.options);
+
+    const std::chrono::duration<double, std::milli> elapsed {
+        std::chrono::steady_clock::now() - begin_time
+    };
+    job.elapsed_ms = elapsed.count();
+}
+
+static void print_summary(const vector<BatchJob> &jobs, unsigned workers, double wall_ms){
+
+    size_t failed {};
+    double total_ms {};
+
+    std::cout << "  line  " << std::left << std::setw(18) << "status"
+              << std::right << std::setw(12) << "time (ms)" << "  command\n";
+
+    for(auto const& job : jobs){
+
+        if(job.result != ErrorCode::success)
+            ++failed;
+
+        total_ms += job.elapsed_ms;
+
+        std::cout << std::setw(6) << job.line << "  "
+                  << std::left << std::setw(18) << error_name(job.result)
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+                  << job.elapsed_ms << "  " << job.command << '\n';
+    }
+
+    std::cout << jobs.size() << " jobs (" << failed << " failed) on " << workers << " threads: "
+              << total_ms << " ms of work in " << wall_ms << " ms\n";
+}
+
+
+
+ErrorCode batch_writer(const string &program, const string &manifest_fn, const Options &options){
+
+    auto&& [code, jobs] { read_manifest(program, manifest_fn, options) };
+    if(code != ErrorCode::success)
+        return code;
+
+    for(auto& job : jobs){
+        job.inputs = job_inputs(job);
+        job.outputs = job_outputs(job);
+    }
+
+    if(has_duplicate_outputs(jobs))
+        return ErrorCode::invalid_argument;
+
+    order_dependent_jobs(jobs);
+
+    const unsigned threads { options.threads > 0 ? options.threads : default_thread_count() };
+    const unsigned workers {
+        static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, jobs.size())))
+    };
+
+    const auto begin_time { std::chrono::steady_clock::now() };
+
+    /**
+     * Workers take the next job in manifest order whenever they are done with one
+     * A job waits for those it must run after, which were all taken before it, so it never waits forever
+     */
+    std::atomic<size_t> next_job { 0 };
+
+    std::mutex done_mutex;
+    std::condition_variable job_done;
+    vector<bool> done(jobs.size(), false);      //guarded by done_mutex
+
+    const auto worker {
+        [&next_job, &done_mutex, &job_done, &done, &jobs = jobs](){
+            for(size_t j { next_job++ }; j < jobs.size(); j = next_job++){
+
+                {
+                    std::unique_lock<std::mutex> lock { done_mutex };
+                    job_done.wait(lock, [&done, &job = jobs[j]](){
+                        return std::all_of(job.after.begin(), job.after.end(),
+                                           [&done](size_t i){ return done[i]; });
+                    });
+                }
+
+                run_job(jobs[j]);
+
+                {
+                    std::lock_guard<std::mutex> lock { done_mutex };
+                    done[j] = true;
+                }
+
+                job_done.notify_all();
+            }
+        }
+    };
+
+    vector<std::thread> pool {};
+    for(unsigned t{}; t < workers; ++t)
+        pool.emplace_back(worker);
+
+    for(auto& w : pool)
+        w.join();
+
+    const std::chrono::duration<double, std::milli> wall {
+        std::chrono::steady_clock::now() - begin_time
+    };
+
+    print_summary(jobs, workers, wall.count());
+
+    for(auto const& job : jobs)
+        if(job.result != ErrorCode::success)
+            return job.result;
+
+    return ErrorCode::success;
+}
@@ -0,0 +1,280 @@
+#include "bernstein.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using std::array;
+using std::vector;
+
+
+
+/** SIMD wrappers **/
+
+#if defined(__AVX__)
+
+using vec_t = __m256d;
+static constexpr size_t LANES { 4 };
+
+static inline vec_t vload(const double *p){ return _mm256_loadu_pd(p); }
+static inline void vstore(double *p, vec_t v){ _mm256_storeu_pd(p, v); }
+static inline vec_t vset(double d){ return _mm256_set1_pd(d); }
+static inline vec_t vadd(vec_t a, vec_t b){ return _mm256_add_pd(a, b); }
+static inline vec_t vsub(vec_t a, vec_t b){ return _mm256_sub_pd(a, b); }
+static inline vec_t vmul(vec_t a, vec_t b){ return _mm256_mul_pd(a, b); }
+static inline vec_t vdiv(vec_t a, vec_t b){ return _mm256_div_pd(a, b); }
+static inline vec_t vsqrt(vec_t a){ return _mm256_sqrt_pd(a); }
+
+//a where mask is non zero, b otherwise
+static inline vec_t vselect_nonzero(vec_t mask, vec_t a, vec_t b){
+    return _mm256_blendv_pd(b, a, _mm256_cmp_pd(mask, _mm256_setzero_pd(), _CMP_NEQ_OQ));
+}
+
+#elif defined(__SSE2__)
+
+using vec_t = __m128d;
+static constexpr size_t LANES { 2 };
+
+static inline vec_t vload(const double *p){ return _mm_loadu_pd(p); }
+static inline void vstore(double *p, vec_t v){ _mm_storeu_pd(p, v); }
+static inline vec_t vset(double d){ return _mm_set1_pd(d); }
+static inline vec_t vadd(vec_t a, vec_t b){ return _mm_add_pd(a, b); }
+static inline vec_t vsub(vec_t a, vec_t b){ return _mm_sub_pd(a, b); }
+static inline vec_t vmul(vec_t a, vec_t b){ return _mm_mul_pd(a, b); }
+static inline vec_t vdiv(vec_t a, vec_t b){ return _mm_div_pd(a, b); }
+static inline vec_t vsqrt(vec_t a){ return _mm_sqrt_pd(a); }
+
+static inline vec_t vselect_nonzero(vec_t mask, vec_t a, vec_t b){
+    const vec_t m { _mm_cmpneq_pd(mask, _mm_setzero_pd()) };
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+}
+
+#else
+
+using vec_t = double;
+static constexpr size_t LANES { 1 };
+
+static inline vec_t vload(const double *p){ return *p; }
+static inline void vstore(double *p, vec_t v){ *p = v; }
+static inline vec_t vset(double d){ return d; }
+static inline vec_t vadd(vec_t a, vec_t b){ return a + b; }
+static inline vec_t vsub(vec_t a, vec_t b){ return a - b; }
+static inline vec_t vmul(vec_t a, vec_t b){ return a * b; }
+static inline vec_t vdiv(vec_t a, vec_t b){ return a / b; }
+static inline vec_t vsqrt(vec_t a){ return std::sqrt(a); }
+
+static inline vec_t vselect_nonzero(vec_t mask, vec_t a, vec_t b){
+    return mask != 0.0 ? a : b;
+}
+
+#endif
+
+
+
+/** BernsteinTable **/
+
+BernsteinTable::BernsteinTable(size_t samples, double time_step) :
+    samples(samples),
+    padded_samples((samples + LANES - 1) / LANES * LANES),
+    time_step(time_step),
+    basis(),
+    deriv()
+{
+    for(size_t k{}; k < 4; ++k){
+        this->basis[k].resize(this->padded_samples);
+        this->deriv[k].resize(this->padded_samples);
+    }
+
+    for(size_t s{}; s < samples; ++s){
+
+        const double t { this->time_at(s) };
+        const double it { 1.0 - t };
+
+        this->basis[0][s] = it * it * it;
+        this->basis[1][s] = 3.0 * t * it * it;
+        this->basis[2][s] = 3.0 * t * t * it;
+        this->basis[3][s] = t * t * t;
+
+        this->deriv[0][s] = -3.0 * it * it;
+        this->deriv[1][s] = 3.0 * it * it - 6.0 * t * it;
+        this->deriv[2][s] = 6.0 * t * it - 3.0 * t * t;
+        this->deriv[3][s] = 3.0 * t * t;
+    }
+}
+
+size_t BernsteinTable::size() const {
+    return this->samples;
+}
+
+size_t BernsteinTable::padded_size() const {
+    return this->padded_samples;
+}
+
+double BernsteinTable::time_at(size_t s) const {
+    return this->time_step * static_cast<double>(s);
+}
+
+double BernsteinTable::basis_at(size_t k, size_t s) const {
+    return this->basis[k][s];
+}
+
+double BernsteinTable::deriv_at(size_t k, size_t s) const {
+    return this->deriv[k][s];
+}
+
+const double* BernsteinTable::basis_row(size_t k) const {
+    return this->basis[k].data();
+}
+
+const double* BernsteinTable::deriv_row(size_t k) const {
+    return this->deriv[k].data();
+}
+
+
+
+/** PatchRow **/
+
+PatchRow::PatchRow(const BernsteinTable &table) :
+    positions(), normals()
+{
+    for(size_t c{}; c < 3; ++c){
+        this->positions[c].resize(table.padded_size());
+        this->normals[c].resize(table.padded_size());
+    }
+}
+
+CartPoint3d PatchRow::position(size_t s) const {
+    return { this->positions[0][s], this->positions[1][s], this->positions[2][s] };
+}
+
+CartPoint3d PatchRow::normal(size_t s) const {
+    return { this->normals[0][s], this->normals[1][s], this->normals[2][s] };
+}
+
+
+
+/**
+ * Normal at sample s of the row at u whose derivatives cross to nothing, as they do
+ * wherever an edge of the patch collapses into a point (e.g. the teapot's lid and bottom)
+ *
+ * Along such an edge the derivative across it vanishes, growing away from it as the
+ * mixed derivative times the distance to the edge, so the normal tends to the cross product
+ * taken with the mixed derivative in its place, pointing away from the edge the patch lies on
+ */
+static CartPoint3d degenerate_normal(const array<array<double, 3>, 4> &curve,
+                                     const array<array<double, 3>, 4> &curve_du,
+                                     const BernsteinTable &table, size_t u, size_t s){
+
+    CartPoint3d du {}, dv {}, duv {};
+
+    for(size_t k{}; k < 4; ++k){
+
+        const double b { table.basis_at(k, s) };
+        const double db { table.deriv_at(k, s) };
+
+        du = { du.x + b * curve_du[k][0], du.y + b * curve_du[k][1], du.z + b * curve_du[k][2] };
+        dv = { dv.x + db * curve[k][0], dv.y + db * curve[k][1], dv.z + db * curve[k][2] };
+        duv = { duv.x + db * curve_du[k][0], duv.y + db * curve_du[k][1], duv.z + db * curve_du[k][2] };
+    }
+
+    //only one of dv and du vanishes along an edge, taking the term it appears in with it
+    const double u_side { table.time_at(u) < 0.5 ? 1.0 : -1.0 };
+    const double v_side { table.time_at(s) < 0.5 ? 1.0 : -1.0 };
+
+    const CartPoint3d across_u { cross_product(duv, du) };
+    const CartPoint3d across_v { cross_product(dv, duv) };
+
+    return CartPoint3d{
+        u_side * across_u.x + v_side * across_v.x,
+        u_side * across_u.y + v_side * across_v.y,
+        u_side * across_u.z + v_side * across_v.z
+    }.normalize();
+}
+
+/**
+ * Evaluate the row of samples at u of the patch whose control points
+ * are given row by row (i.e. ctrl_points[4 * a + k] is P(a, k))
+ *
+ * The patch is first collapsed along u into the control points of a cubic curve
+ * in v (and of its derivative in u), so that each sample of the row takes
+ * 36 multiply-adds, which are carried out LANES samples at a time
+ */
+void evaluate_patch_row(const array<CartPoint3d, NUM_OF_PATCH_POINTS> &ctrl_points,
+                        const BernsteinTable &table, size_t u, PatchRow &row){
+
+    array<array<double, 3>, 4> curve {};
+    array<array<double, 3>, 4> curve_du {};
+
+    for(size_t a{}; a < 4; ++a){
+
+        const double b { table.basis_at(a, u) };
+        const double db { table.deriv_at(a, u) };
+
+        for(size_t k{}; k < 4; ++k){
+
+            const CartPoint3d &p { ctrl_points[4 * a + k] };
+
+            curve[k][0] += b * p.x;
+            curve[k][1] += b * p.y;
+            curve[k][2] += b * p.z;
+
+            curve_du[k][0] += db * p.x;
+            curve_du[k][1] += db * p.y;
+            curve_du[k][2] += db * p.z;
+        }
+    }
+
+    //plain arrays, as std::array would drop the vector types' alignment attributes
+    vec_t q[4][3], dq[4][3];
+    for(size_t k{}; k < 4; ++k)
+        for(size_t c{}; c < 3; ++c){
+            q[k][c] = vset(curve[k][c]);
+            dq[k][c] = vset(curve_du[k][c]);
+        }
+
+    for(size_t s{}; s < table.padded_size(); s += LANES){
+
+        vec_t pos[3], du[3], dv[3];
+        for(size_t c{}; c < 3; ++c)
+            pos[c] = du[c] = dv[c] = vset(0.0);
+
+        for(size_t k{}; k < 4; ++k){
+
+            const vec_t b { vload(table.basis_row(k) + s) };
+            const vec_t db { vload(table.deriv_row(k) + s) };
+
+            for(size_t c{}; c < 3; ++c){
+                pos[c] = vadd(pos[c], vmul(q[k][c], b));
+                du[c] = vadd(du[c], vmul(dq[k][c], b));
+                dv[c] = vadd(dv[c], vmul(q[k][c], db));
+            }
+        }
+
+        //normal is dv x du, normalized unless it is null (collapsed patch edges, see degenerate_normal)
+        const vec_t nx { vsub(vmul(dv[1], du[2]), vmul(dv[2], du[1])) };
+        const vec_t ny { vsub(vmul(dv[2], du[0]), vmul(dv[0], du[2])) };
+        const vec_t nz { vsub(vmul(dv[0], du[1]), vmul(dv[1], du[0])) };
+
+        const vec_t norm {
+            vsqrt(vadd(vadd(vmul(nx, nx), vmul(ny, ny)), vmul(nz, nz)))
+        };
+
+        for(size_t c{}; c < 3; ++c)
+            vstore(row.positions[c].data() + s, pos[c]);
+
+        vstore(row.normals[0].data() + s, vselect_nonzero(norm, vdiv(nx, norm), nx));
+        vstore(row.normals[1].data() + s, vselect_nonzero(norm, vdiv(ny, norm), ny));
+        vstore(row.normals[2].data() + s, vselect_nonzero(norm, vdiv(nz, norm), nz));
+    }
+
+    //null normals are rare enough to be replaced one by one
+    for(size_t s{}; s < table.size(); ++s)
+        if(row.normals[0][s] == 0.0 && row.normals[1][s] == 0.0 && row.normals[2][s] == 0.0){
+
+            const CartPoint3d n { degenerate_normal(curve, curve_du, table, u, s) };
+
+            row.normals[0][s] = n.x;
+            row.normals[1][s] = n.y;
+            row.normals[2][s] = n.z;
+        }
+}
@@ -0,0 +1,177 @@
+#include "cache.hpp"
+#include "mesh.hpp"
+#include "filters.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using std::string;
+using std::vector;
+
+
+
+//incremental FNV-1a
+class Hasher {
+
+private:
+    uint64_t hash;
+
+public:
+    Hasher();
+
+    void add(const char *data, size_t size);
+    void add(const string &str);
+    void add(uint64_t value);
+
+    uint64_t value() const;
+};
+
+Hasher::Hasher() :
+    hash(14695981039346656037ULL) {}
+
+void Hasher::add(const char *data, size_t size){
+    for(size_t i{}; i < size; ++i){
+        this->hash ^= static_cast<unsigned char>(data[i]);
+        this->hash *= 1099511628211ULL;
+    }
+}
+
+//the terminating null keeps ("ab", "c") and ("a", "bc") apart
+void Hasher::add(const string &str){
+    this->add(str.c_str(), str.size() + 1);
+}
+
+void Hasher::add(uint64_t value){
+    for(unsigned i{}; i < sizeof(value); ++i, value >>= 8){
+        const char byte { static_cast<char>(value & 0xff) };
+        this->add(&byte, 1);
+    }
+}
+
+uint64_t Hasher::value() const {
+    return this->hash;
+}
+
+
+
+vector<string> output_files(const string &out_fn, const Options &options){
+
+    if(options.binary)
+        return { out_fn };
+
+    return { out_fn, to_norm_extension(out_fn), to_text_extension(out_fn), to_bounds_extension(out_fn) };
+}
+
+vector<string> input_files(const vector<string> &args){
+
+    vector<string> inputs {};
+
+    //a .3d input may be a text model, whose normals and texture coordinates live alongside
+    for(size_t i { 1 }; i + 1 < args.size(); ++i){
+
+        inputs.push_back(args[i]);
+
+        if(has_3d_ext(args[i])){
+            inputs.push_back(to_norm_extension(args[i]));
+            inputs.push_back(to_text_extension(args[i]));
+        }
+    }
+
+    return inputs;
+}
+
+uint64_t generation_hash(const vector<string> &args, const Options &options){
+
+    Hasher hasher {};
+
+    hasher.add(GENERATOR_VERSION);
+    hasher.add(MESH_VERSION);
+
+    //the thread count is left out on purpose, as it doesn't change the output
+    hasher.add(options.binary);
+    hasher.add(options.single_precision);
+    hasher.add(options.indexed);
+
+    uint64_t tolerance_bits {};
+    std::memcpy(&tolerance_bits, &options.tolerance, sizeof(tolerance_bits));
+    hasher.add(tolerance_bits);
+    hasher.add(options.overdraw);
+    hasher.add(options.quantize);
+    hasher.add(options.meshlet_vertexes);
+    hasher.add(options.meshlet_triangles);
+
+    //only simplify writes several levels at once, lod_writer hashes each level on its own
+    hasher.add(options.lods);
+
+    uint64_t max_error_bits {};
+    std::memcpy(&max_error_bits, &options.max_error, sizeof(max_error_bits));
+    hasher.add(max_error_bits);
+
+    //streaming only changes indexed output, whose tile seams depend on the budget
+    hasher.add(options.indexed ? options.memory : 0);
+
+    //the program name is irrelevant
+    for(size_t i { 1 }; i < args.size(); ++i)
+        hasher.add(args[i]);
+
+    /**
+     * Any argument naming a readable file, other than the output, is an input
+     * Inputs may span gigabytes, so they are hashed off a mapping rather than copied,
+     * followed by a null as strings are, so that the hashes of unchanged inputs stay the same
+     */
+    static constexpr char TERMINATOR { '\0' };
+
+    for(auto const& fn : input_files(args)){
+
+        const MappedFile input { fn };
+
+        if(!input.is_open())
+            continue;
+
+        hasher.add(input.data(), input.size());
+        hasher.add(&TERMINATOR, 1);
+    }
+
+    return hasher.value();
+}
+
+bool is_up_to_date(const string &out_fn, const Options &options, uint64_t hash){
+
+    std::ifstream hash_file{};
+    hash_file.open(to_hash_extension(out_fn), std::ios::in);
+
+    uint64_t recorded {};
+    if(!hash_file.is_open() || !(hash_file >> std::hex >> recorded) || recorded != hash)
+        return false;
+
+    for(auto const& fn : output_files(out_fn, options)){
+
+        std::ifstream file{};
+        file.open(fn, std::ios::in);
+
+        if(!file.is_open())
+            return false;
+    }
+
+    return true;
+}
+
+ErrorCode record_hash(const string &out_fn, uint64_t hash){
+
+    std::ofstream hash_file{};
+    hash_file.open(to_hash_extension(out_fn), std::ios::out | std::ios::trunc);
+
+    if(!hash_file.is_open())
+        return ErrorCode::io_error;
+
+    hash_file << std::hex << hash << '\n';
+
+    return hash_file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+//an output which is being rewritten is no longer up to date, should the run fail
+void forget_hash(const string &out_fn){
+    std::remove(to_hash_extension(out_fn).c_str());
+}
@@ -6,8 +6,30 @@ static void usage(){
         "\t generator box <units> <grid_size> <output_file>\n" <<
         "\t generator cone <radius> <height> <slices> <stacks> <output_file>\n" <<
         "\t generator sphere <radius> <slices> <stacks> <output_file>\n"  <<
+        "\t generator icosphere <radius> <subdivisions> <output_file>\n" <<
+        "\t generator cubesphere <radius> <divisions> <output_file>\n" <<
         "\t generator torus <outter_radius> <inner_radius> <slices> <stacks> <output_file>\n" <<
-        "\t generator bezier <input_file> <tesselation_level> <output_file>\n";
+        "\t generator bezier <input_file> <tesselation_level> <output_file>\n" <<
+        "\t generator optimize <input_file> <output_file>\n" <<
+        "\t generator simplify <input_file> <triangles> <output_file>\n" <<
+        "\t generator batch <manifest_file>\n" <<
+        "Options: \n" <<
+        "\t --binary \t write a single binary .3d file instead of .3d/.norm/.text text files\n" <<
+        "\t --float  \t same as --binary, storing single precision values\n" <<
+        "\t --indexed\t same as --binary, welding equal vertexes and storing 32 bit indexes\n" <<
+        "\t --quantize <8|16>\t same as --binary, storing 16 bit positions and texture coordinates\n" <<
+        "\t                 \t and octahedral normals of 8 or 16 bit components\n" <<
+        "\t --meshlets <v> <t>\t same as --indexed, splitting the triangles into meshlets of at most\n" <<
+        "\t                   \t v vertexes and t triangles, for the engine to cull each on its own\n" <<
+        "\t --threads <n>\t number of threads generating the model (defaults to one per core)\n" <<
+        "\t --force  \t regenerate the output even if it is up to date\n" <<
+        "\t --memory <MiB>\t generate and write the model in tiles, keeping memory within about MiB\n" <<
+        "\t --lods <n>\t also write n - 1 coarser levels of detail, each with about half the triangles\n" <<
+        "\t --tolerance <t>\t tesselate each bezier patch adaptively, so that the surface strays at most t\n" <<
+        "\t                \t from its triangles, using the tesselation level as the maximum\n" <<
+        "\t --overdraw\t have optimize also sort clusters of triangles to reduce overdraw\n" <<
+        "\t --max-error <e>\t have simplify stop short of the target rather than stray more than e\n" <<
+        "\t                \t from the input (doubled for each coarser level of detail)\n";
 }
 
 void handle_error(const ErrorCode e){
@@ -39,6 +61,10 @@ void handle_error(const ErrorCode e){
         std::cerr << "Invalid patch formatting.\n";
         break;
 
+    case ErrorCode::index_overflow:
+        std::cerr << "Too many vertexes or indexes for 32 bit indexes.\n";
+        break;
+
     default:
         break;
     }
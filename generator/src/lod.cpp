@@ -0,0 +1,172 @@
+#include "lod.hpp"
+#include "primitive.hpp"
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using std::string;
+using std::vector;
+using std::tuple;
+using std::map;
+
+
+
+//an argument which sets the resolution of a primitive
+struct ResolutionArg {
+    size_t index;       //position among the positional arguments
+    int minimum;
+    bool even;
+};
+
+static const map<string, vector<ResolutionArg>> RESOLUTION_ARGS {
+    { "plane",  { { 3, 1, false } } },
+    { "box",    { { 3, 1, false } } },
+    { "cone",   { { 4, 3, false }, { 5, 1, false } } },
+    { "sphere", { { 3, 3, false }, { 4, 2, true } } },
+    { "torus",  { { 4, 3, false }, { 5, 2, true } } },
+    { "bezier", { { 3, 1, false } } },
+    { "icosphere",  { { 3, 1, false } } },
+    { "cubesphere", { { 3, 1, false } } },
+};
+
+
+
+static int scale_resolution(int value, double factor, const ResolutionArg &arg){
+
+    int scaled {
+        arg.even
+            ? 2 * static_cast<int>(std::lround(value * factor / 2.0))
+            : static_cast<int>(std::lround(value * factor))
+    };
+
+    return std::max(scaled, arg.minimum);
+}
+
+string lod_filename(const string &fn, unsigned level){
+
+    if(level == 0)
+        return fn;
+
+    return fn.substr(0, fn.size() - 3) + "_lod" + std::to_string(level) + ".3d";
+}
+
+string lods_filename(const string &fn){
+    return fn.substr(0, fn.size() - 3) + ".lods";
+}
+
+static string strip_directory(const string &fn){
+
+    const size_t last_sep { fn.find_last_of("/\\") };
+
+    return last_sep == string::npos ? fn : fn.substr(last_sep + 1);
+}
+
+static tuple<ErrorCode, uint64_t> count_triangles(const string &fn){
+
+    if(is_binary_mesh(fn)){
+
+        auto const& [code, header] { read_binary_mesh_header(fn) };
+
+        const uint64_t count {
+            header.index_count > 0 ? header.index_count : header.vertex_count
+        };
+
+        return { code, count / 3 };
+    }
+
+    //text files hold a vertex per line
+    std::ifstream file{};
+    file.open(fn, std::ios::in | std::ios::binary);
+
+    if(!file.is_open())
+        return { ErrorCode::io_error, 0 };
+
+    vector<char> buffer(1 << 16);
+    uint64_t lines {};
+
+    while(file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+        lines += static_cast<uint64_t>(
+            std::count(buffer.begin(), buffer.begin() + file.gcount(), '\n')
+        );
+
+    return { ErrorCode::success, lines / 3 };
+}
+
+
+
+ErrorCode write_lods_file(const string &out_fn, const vector<uint64_t> &triangles){
+
+    const string lods_fn { lods_filename(out_fn) };
+
+    std::ofstream lods_file{};
+    lods_file.open(lods_fn, std::ios::out | std::ios::trunc);
+
+    if(!lods_file.is_open())
+        return ErrorCode::io_error;
+
+    lods_file << "# level triangles file\n";
+
+    for(unsigned level{}; level < triangles.size(); ++level)
+        lods_file << level << ' ' << triangles[level] << ' ' << strip_directory(lod_filename(out_fn, level)) << '\n';
+
+    return lods_file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+ErrorCode lod_writer(const vector<string> &args, const Options &options){
+
+    Options level_options { options };
+    level_options.lods = 1;
+
+    //anything that isn't a well formed primitive is left for primitive_writer to report
+    if(args.size() < 2 || RESOLUTION_ARGS.count(args[1]) == 0 || !has_3d_ext(args.back()))
+        return primitive_writer(args, level_options);
+
+    const vector<ResolutionArg> &resolution_args { RESOLUTION_ARGS.at(args[1]) };
+
+    vector<int> base_values {};
+    for(auto const& arg : resolution_args)
+        base_values.push_back(arg.index + 1 < args.size() ? string_to_uint(args[arg.index]) : -1);
+
+    const string &out_fn { args.back() };
+
+    vector<uint64_t> level_triangles {};
+    vector<string> prev_level_args {};
+
+    for(unsigned level{}; level < options.lods; ++level){
+
+        const double factor { std::pow(2.0, -0.5 * static_cast<double>(level)) };
+
+        vector<string> level_args { args };
+
+        /**
+         * Level 0 gets the arguments as given, for primitive_writer to reject invalid ones,
+         * as scaling would round them up to their minimum or parity; the others are
+         * only reached once level 0 succeeded, so their base values are valid
+         */
+        for(size_t i{}; level > 0 && i < resolution_args.size(); ++i)
+            if(base_values[i] > 0)
+                level_args[resolution_args[i].index] =
+                    std::to_string(scale_resolution(base_values[i], factor, resolution_args[i]));
+
+        //the resolution can't be lowered any further
+        if(level_args == prev_level_args)
+            break;
+
+        prev_level_args = level_args;
+        level_args.back() = lod_filename(out_fn, level);
+
+        const ErrorCode code { primitive_writer(level_args, level_options) };
+        if(code != ErrorCode::success)
+            return code;
+
+        auto const& [count_code, triangles] { count_triangles(level_args.back()) };
+        if(count_code != ErrorCode::success)
+            return count_code;
+
+        level_triangles.push_back(triangles);
+    }
+
+    return write_lods_file(out_fn, level_triangles);
+}
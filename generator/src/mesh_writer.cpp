@@ -0,0 +1,61 @@
+#include "mesh_writer.hpp"
+#include "meshlets.hpp"
+
+using std::string;
+using std::vector;
+
+
+
+static ErrorCode text_writer(const string &filename, const Mesh &mesh){
+
+    //formatting carries on while the text formatted so far is written
+    OutputSink sink {};
+
+    TextWriter vertexes_file { sink, filename };
+    TextWriter normals_file { sink, to_norm_extension(filename) };
+    TextWriter text_file { sink, to_text_extension(filename) };
+
+    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
+        return ErrorCode::io_error;
+
+    for(auto const& p : mesh.vertexes)
+        vertexes_file << p;
+
+    for(auto const& n : mesh.normals)
+        normals_file << n;
+
+    for(auto const& t : mesh.text_coords)
+        text_file << t;
+
+    const bool flushed { vertexes_file.flush() && normals_file.flush() && text_file.flush() };
+    if(!flushed)
+        return ErrorCode::io_error;
+
+    //points are written in full, so the bounds hold them as read back
+    return write_bounds(to_bounds_extension(filename), points_bounds(mesh.vertexes));
+}
+
+//write the mesh as a binary file, quantized or with the precision requested by the options
+ErrorCode binary_writer(const string &filename, const Mesh &mesh, const Options &options){
+
+    if(options.quantize > 0)
+        return write_quantized_mesh(filename, mesh, options.quantize);
+
+    return write_binary_mesh(filename, mesh, options.single_precision);
+}
+
+//write the mesh in the format requested by the options
+//indexed output welds the mesh in place
+ErrorCode write_mesh(const string &filename, Mesh &mesh, const Options &options){
+
+    if(options.indexed)
+        weld(mesh);
+
+    if(options.meshlet_triangles > 0)
+        build_meshlets(mesh, options.meshlet_vertexes, options.meshlet_triangles);
+
+    if(options.binary)
+        return binary_writer(filename, mesh, options);
+
+    return text_writer(filename, mesh);
+}
@@ -0,0 +1,197 @@
+#include "meshlets.hpp"
+
+#include <limits>
+#include <vector>
+
+using std::vector;
+
+
+
+//the triangles using each vertex v are triangles[offsets[v]] up to triangles[offsets[v + 1]]
+struct Adjacency {
+    vector<uint32_t> offsets;
+    vector<uint32_t> triangles;
+};
+
+static Adjacency build_adjacency(const vector<uint32_t> &indexes, size_t vertex_count){
+
+    Adjacency adjacency { vector<uint32_t>(vertex_count + 1, 0), vector<uint32_t>(indexes.size()) };
+
+    for(uint32_t i : indexes)
+        ++adjacency.offsets[i + 1];
+
+    for(size_t v{}; v < vertex_count; ++v)
+        adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+    vector<uint32_t> filled { adjacency.offsets.begin(), adjacency.offsets.end() - 1 };
+
+    for(size_t i{}; i < indexes.size(); ++i)
+        adjacency.triangles[filled[indexes[i]]++] = static_cast<uint32_t>(i / 3);
+
+    return adjacency;
+}
+
+static CartPoint3d centroid(const Mesh &mesh, size_t triangle){
+
+    const CartPoint3d &a { mesh.vertexes[mesh.indexes[3 * triangle]] };
+    const CartPoint3d &b { mesh.vertexes[mesh.indexes[3 * triangle + 1]] };
+    const CartPoint3d &c { mesh.vertexes[mesh.indexes[3 * triangle + 2]] };
+
+    return { (a.x + b.x + c.x) / 3.0, (a.y + b.y + c.y) / 3.0, (a.z + b.z + c.z) / 3.0 };
+}
+
+static double distance_squared(const CartPoint3d &a, const CartPoint3d &b){
+
+    const double dx { a.x - b.x };
+    const double dy { a.y - b.y };
+    const double dz { a.z - b.z };
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
+//the unused candidate closest to center, compacting away used ones, or triangle_count if there is none
+static size_t closest_candidate(vector<uint32_t> &candidates, const vector<bool> &used,
+                                const Mesh &mesh, const CartPoint3d &center, size_t triangle_count){
+
+    size_t best { triangle_count };
+    double best_distance { std::numeric_limits<double>::max() };
+
+    size_t kept {};
+
+    for(uint32_t t : candidates){
+
+        if(used[t])
+            continue;
+
+        candidates[kept++] = t;
+
+        const double distance { distance_squared(centroid(mesh, t), center) };
+        if(distance < best_distance){
+            best = t;
+            best_distance = distance;
+        }
+    }
+
+    candidates.resize(kept);
+
+    return best;
+}
+
+void build_meshlets(Mesh &mesh, size_t max_vertexes, size_t max_triangles){
+
+    mesh.meshlets.clear();
+
+    if(!mesh.is_indexed() || max_vertexes < 3 || max_triangles == 0)
+        return;
+
+    const size_t triangle_count { mesh.indexes.size() / 3 };
+    const Adjacency adjacency { build_adjacency(mesh.indexes, mesh.vertexes.size()) };
+
+    vector<bool> used(triangle_count, false);
+
+    //the meshlet (plus one) each vertex was last added to, or each triangle was last a candidate of
+    vector<uint32_t> vertex_meshlet(mesh.vertexes.size(), 0);
+    vector<uint32_t> candidate_meshlet(triangle_count, 0);
+
+    vector<uint32_t> indexes {};
+    indexes.reserve(mesh.indexes.size());
+
+    vector<uint32_t> candidates {};
+    size_t first_unused {};
+    size_t seed { triangle_count };
+
+    while(indexes.size() < 3 * triangle_count){
+
+        //meshlets carry on from a triangle left next to the previous one, if any
+        if(seed == triangle_count){
+            while(used[first_unused])
+                ++first_unused;
+            seed = first_unused;
+        }
+
+        const uint32_t stamp { static_cast<uint32_t>(mesh.meshlets.size() + 1) };
+        const uint32_t first_index { static_cast<uint32_t>(indexes.size()) };
+
+        candidates.clear();
+
+        size_t vertexes {};
+        size_t triangles {};
+        CartPoint3d centroid_sum {};
+        CartPoint3d center {};
+
+        for(size_t t { seed }; t < triangle_count; ){
+
+            used[t] = true;
+            ++triangles;
+
+            centroid_sum += centroid(mesh, t);
+            center = centroid_sum * (1.0 / static_cast<double>(triangles));
+
+            for(size_t c{}; c < 3; ++c){
+
+                const uint32_t v { mesh.indexes[3 * t + c] };
+                indexes.push_back(v);
+
+                if(vertex_meshlet[v] == stamp)
+                    continue;
+
+                vertex_meshlet[v] = stamp;
+                ++vertexes;
+
+                for(uint32_t a { adjacency.offsets[v] }; a < adjacency.offsets[v + 1]; ++a){
+
+                    const uint32_t u { adjacency.triangles[a] };
+
+                    if(!used[u] && candidate_meshlet[u] != stamp){
+                        candidate_meshlet[u] = stamp;
+                        candidates.push_back(u);
+                    }
+                }
+            }
+
+            if(triangles == max_triangles)
+                break;
+
+            //the candidate bringing in the fewest new vertexes, then the closest one
+            size_t best { triangle_count };
+            size_t best_new { 4 };
+            double best_distance { std::numeric_limits<double>::max() };
+
+            size_t kept {};
+
+            for(uint32_t u : candidates){
+
+                if(used[u])
+                    continue;
+
+                candidates[kept++] = u;
+
+                size_t new_vertexes {};
+                for(size_t c{}; c < 3; ++c)
+                    if(vertex_meshlet[mesh.indexes[3 * u + c]] != stamp)
+                        ++new_vertexes;
+
+                if(vertexes + new_vertexes > max_vertexes || new_vertexes > best_new)
+                    continue;
+
+                const double distance { distance_squared(centroid(mesh, u), center) };
+
+                if(new_vertexes < best_new || distance < best_distance){
+                    best = u;
+                    best_new = new_vertexes;
+                    best_distance = distance;
+                }
+            }
+
+            candidates.resize(kept);
+
+            t = best;
+        }
+
+        mesh.meshlets.emplace_back(first_index, static_cast<uint32_t>(indexes.size()) - first_index);
+
+        seed = closest_candidate(candidates, used, mesh, center, triangle_count);
+    }
+
+    mesh.indexes = std::move(indexes);
+}
@@ -0,0 +1,429 @@
+#include "optimize.hpp"
+#include "text_reader.hpp"
+#include "mesh_writer.hpp"
+#include "meshlets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+using std::string;
+using std::vector;
+
+
+
+/** Statistics **/
+
+CacheStats::CacheStats() :
+    acmr(0.0), atvr(0.0) {}
+
+CacheStats cache_stats(const vector<uint32_t> &indexes, size_t vertex_count, size_t cache_size){
+
+    CacheStats stats {};
+
+    if(indexes.size() < 3 || vertex_count == 0)
+        return stats;
+
+    //the step at which each vertex last entered the cache
+    vector<size_t> entered(vertex_count, 0);
+    vector<bool> seen(vertex_count, false);
+
+    size_t misses {};
+    size_t used_vertexes {};
+
+    for(uint32_t i : indexes){
+
+        //a FIFO cache holds the last cache_size vertexes that missed
+        if(!seen[i]){
+            seen[i] = true;
+            ++used_vertexes;
+            entered[i] = ++misses;
+        }
+        else if(misses - entered[i] >= cache_size)
+            entered[i] = ++misses;
+    }
+
+    stats.acmr = static_cast<double>(misses) / static_cast<double>(indexes.size() / 3);
+    stats.atvr = static_cast<double>(misses) / static_cast<double>(used_vertexes);
+
+    return stats;
+}
+
+
+
+/** Vertex cache optimization **/
+
+/**
+ * Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+ * Triangles are picked greedily by the sum of their vertexes' scores, which favour
+ * vertexes recently used (in the simulated LRU cache) and those with few triangles left,
+ * so that no vertex is left behind to be transformed again later on
+ */
+
+static constexpr double CACHE_DECAY_POWER { 1.5 };
+static constexpr double LAST_TRIANGLE_SCORE { 0.75 };
+static constexpr double VALENCE_BOOST_SCALE { 2.0 };
+static constexpr double VALENCE_BOOST_POWER { 0.5 };
+
+static double vertex_score(int cache_pos, size_t live_triangles){
+
+    if(live_triangles == 0)
+        return -1.0;
+
+    double score {};
+
+    if(cache_pos >= 0){
+
+        //the vertexes of the last triangle get a fixed score, so as not to favour any of them
+        if(cache_pos < 3)
+            score = LAST_TRIANGLE_SCORE;
+        else{
+            const double scaler { 1.0 / static_cast<double>(VERTEX_CACHE_SIZE - 3) };
+            score = std::pow(1.0 - static_cast<double>(cache_pos - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    score += VALENCE_BOOST_SCALE *
+             std::pow(static_cast<double>(live_triangles), -VALENCE_BOOST_POWER);
+
+    return score;
+}
+
+vector<uint32_t> optimize_vertex_cache(const vector<uint32_t> &indexes, size_t vertex_count){
+
+    const size_t num_of_triangles { indexes.size() / 3 };
+
+    //triangles of each vertex, as a single array with per vertex offsets
+    vector<size_t> offsets(vertex_count + 1, 0);
+    for(uint32_t i : indexes)
+        ++offsets[i + 1];
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    vector<size_t> vertex_triangles(indexes.size());
+    {
+        vector<size_t> fill { offsets.begin(), offsets.end() - 1 };
+        for(size_t k{}; k < indexes.size(); ++k)
+            vertex_triangles[fill[indexes[k]]++] = k / 3;
+    }
+
+    vector<size_t> live_triangles(vertex_count);
+    for(size_t v{}; v < vertex_count; ++v)
+        live_triangles[v] = offsets[v + 1] - offsets[v];
+
+    vector<int> cache_pos(vertex_count, -1);
+    vector<double> scores(vertex_count);
+    for(size_t v{}; v < vertex_count; ++v)
+        scores[v] = vertex_score(-1, live_triangles[v]);
+
+    vector<double> triangle_scores(num_of_triangles);
+    for(size_t t{}; t < num_of_triangles; ++t)
+        triangle_scores[t] = scores[indexes[3 * t]] + scores[indexes[3 * t + 1]] + scores[indexes[3 * t + 2]];
+
+    vector<bool> emitted(num_of_triangles, false);
+    vector<uint32_t> res {};
+    res.reserve(indexes.size());
+
+    vector<uint32_t> cache {};
+    vector<uint32_t> new_cache {};
+
+    size_t next_unemitted {};
+    size_t best_triangle { 0 };
+
+    for(size_t count{}; count < num_of_triangles; ++count){
+
+        /**
+         * If no triangle touching the cache is left, move on to the next one in input order
+         * rather than searching every triangle, which keeps this linear
+         */
+        if(best_triangle == num_of_triangles){
+
+            while(emitted[next_unemitted])
+                ++next_unemitted;
+
+            best_triangle = next_unemitted;
+        }
+
+        emitted[best_triangle] = true;
+
+        new_cache.clear();
+
+        for(size_t k{}; k < 3; ++k){
+
+            const uint32_t v { indexes[3 * best_triangle + k] };
+            res.push_back(v);
+            new_cache.push_back(v);
+
+            --live_triangles[v];
+        }
+
+        for(uint32_t v : cache)
+            if(std::find(new_cache.begin(), new_cache.begin() + 3, v) == new_cache.begin() + 3)
+                new_cache.push_back(v);
+
+        //vertexes pushed out of the cache
+        for(size_t p { VERTEX_CACHE_SIZE }; p < new_cache.size(); ++p){
+            cache_pos[new_cache[p]] = -1;
+            scores[new_cache[p]] = vertex_score(-1, live_triangles[new_cache[p]]);
+        }
+
+        new_cache.resize(std::min(new_cache.size(), VERTEX_CACHE_SIZE));
+        std::swap(cache, new_cache);
+
+        for(size_t p{}; p < cache.size(); ++p){
+            cache_pos[cache[p]] = static_cast<int>(p);
+            scores[cache[p]] = vertex_score(static_cast<int>(p), live_triangles[cache[p]]);
+        }
+
+        //only the triangles of cached vertexes may have changed score
+        best_triangle = num_of_triangles;
+        double best_score { -1.0 };
+
+        for(uint32_t v : cache)
+            for(size_t k { offsets[v] }; k < offsets[v + 1]; ++k){
+
+                const size_t t { vertex_triangles[k] };
+                if(emitted[t])
+                    continue;
+
+                triangle_scores[t] = scores[indexes[3 * t]] + scores[indexes[3 * t + 1]] + scores[indexes[3 * t + 2]];
+
+                if(triangle_scores[t] > best_score){
+                    best_score = triangle_scores[t];
+                    best_triangle = t;
+                }
+            }
+    }
+
+    return res;
+}
+
+
+
+/** Overdraw optimization **/
+
+/**
+ * After cache optimization, the triangle sequence breaks into clusters wherever
+ * a triangle shares no vertex with the cache, as the optimizer then jumped elsewhere.
+ * Clusters are sorted so that those facing away from the centre of the mesh,
+ * which tend to occlude the others, are drawn first. As whole clusters are moved,
+ * cache locality within them is kept.
+ */
+vector<uint32_t> optimize_overdraw(const vector<uint32_t> &indexes, const Mesh &mesh){
+
+    const size_t num_of_triangles { indexes.size() / 3 };
+
+    CartPoint3d mesh_center {};
+    for(auto const& v : mesh.vertexes){
+        mesh_center.x += v.x;
+        mesh_center.y += v.y;
+        mesh_center.z += v.z;
+    }
+
+    const double num_of_vertexes { static_cast<double>(std::max<size_t>(mesh.vertexes.size(), 1)) };
+    mesh_center = { mesh_center.x / num_of_vertexes, mesh_center.y / num_of_vertexes, mesh_center.z / num_of_vertexes };
+
+
+
+    //first triangle of each cluster
+    vector<size_t> cluster_starts {};
+    {
+        std::deque<uint32_t> cache {};
+
+        for(size_t t{}; t < num_of_triangles; ++t){
+
+            bool hit { false };
+
+            for(size_t k{}; k < 3; ++k){
+
+                const uint32_t v { indexes[3 * t + k] };
+
+                if(std::find(cache.begin(), cache.end(), v) != cache.end())
+                    hit = true;
+                else{
+                    cache.push_back(v);
+                    if(cache.size() > VERTEX_CACHE_SIZE)
+                        cache.pop_front();
+                }
+            }
+
+            if(!hit)
+                cluster_starts.push_back(t);
+        }
+    }
+
+    cluster_starts.push_back(num_of_triangles);
+
+
+
+    //how much each cluster faces away from the centre, weighted by area
+    vector<double> sort_keys(cluster_starts.size() - 1);
+
+    for(size_t c{}; c + 1 < cluster_starts.size(); ++c){
+
+        CartPoint3d centroid {}, normal {};
+        double area {};
+
+        for(size_t t { cluster_starts[c] }; t < cluster_starts[c + 1]; ++t){
+
+            const CartPoint3d &a { mesh.vertexes[indexes[3 * t]] };
+            const CartPoint3d &b { mesh.vertexes[indexes[3 * t + 1]] };
+            const CartPoint3d &d { mesh.vertexes[indexes[3 * t + 2]] };
+
+            const CartPoint3d u { b.x - a.x, b.y - a.y, b.z - a.z };
+            const CartPoint3d w { d.x - a.x, d.y - a.y, d.z - a.z };
+
+            const CartPoint3d n {
+                u.y * w.z - u.z * w.y,
+                u.z * w.x - u.x * w.z,
+                u.x * w.y - u.y * w.x
+            };
+
+            const double triangle_area { std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z) };
+
+            centroid.x += (a.x + b.x + d.x) / 3.0 * triangle_area;
+            centroid.y += (a.y + b.y + d.y) / 3.0 * triangle_area;
+            centroid.z += (a.z + b.z + d.z) / 3.0 * triangle_area;
+
+            normal.x += n.x;
+            normal.y += n.y;
+            normal.z += n.z;
+
+            area += triangle_area;
+        }
+
+        if(area > 0.0)
+            centroid = { centroid.x / area, centroid.y / area, centroid.z / area };
+
+        normal = normal.normalize();
+
+        sort_keys[c] =
+            (centroid.x - mesh_center.x) * normal.x +
+            (centroid.y - mesh_center.y) * normal.y +
+            (centroid.z - mesh_center.z) * normal.z;
+    }
+
+    vector<size_t> order(sort_keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sort_keys](size_t a, size_t b){ return sort_keys[a] > sort_keys[b]; });
+
+    vector<uint32_t> res {};
+    res.reserve(indexes.size());
+
+    for(size_t c : order)
+        res.insert(
+            res.end(),
+            indexes.begin() + static_cast<std::ptrdiff_t>(3 * cluster_starts[c]),
+            indexes.begin() + static_cast<std::ptrdiff_t>(3 * cluster_starts[c + 1])
+        );
+
+    return res;
+}
+
+
+
+/** Vertex fetch optimization **/
+
+//lay the vertexes out in the order they are first used, for the fetches to run through memory
+void optimize_vertex_fetch(Mesh &mesh){
+
+    const bool has_normals { mesh.normals.size() == mesh.vertexes.size() };
+    const bool has_text_coords { mesh.text_coords.size() == mesh.vertexes.size() };
+
+    static constexpr uint32_t UNMAPPED { UINT32_MAX };
+    vector<uint32_t> remap(mesh.vertexes.size(), UNMAPPED);
+
+    Mesh res {};
+    res.indexes.reserve(mesh.indexes.size());
+
+    for(uint32_t i : mesh.indexes){
+
+        if(remap[i] == UNMAPPED){
+
+            remap[i] = static_cast<uint32_t>(res.vertexes.size());
+            res.vertexes.push_back(mesh.vertexes[i]);
+
+            if(has_normals)
+                res.normals.push_back(mesh.normals[i]);
+
+            if(has_text_coords)
+                res.text_coords.push_back(mesh.text_coords[i]);
+        }
+
+        res.indexes.push_back(remap[i]);
+    }
+
+    //the triangles keep their order
+    res.meshlets = std::move(mesh.meshlets);
+    mesh = std::move(res);
+}
+
+
+
+static void print_stats(const string &step, const vector<uint32_t> &indexes, size_t vertex_count){
+
+    const CacheStats stats { cache_stats(indexes, vertex_count) };
+
+    std::cout << "  " << std::left << std::setw(20) << step << std::right << std::fixed << std::setprecision(3)
+              << std::setw(8) << stats.acmr << std::setw(8) << stats.atvr
+              << std::setw(12) << vertex_count << '\n';
+}
+
+ErrorCode optimize_writer(const string &in_fn, const string &out_fn, const Options &options){
+
+    auto&& [code, mesh] { read_mesh(in_fn) };
+
+    if(code != ErrorCode::success)
+        return code;
+
+    if(mesh.vertexes.size() % 3 != 0 && !mesh.is_indexed())
+        return ErrorCode::invalid_file_formatting;
+
+    //attributes which don't cover every vertex are dropped, rather than welded wrongly
+    if(mesh.normals.size() != mesh.vertexes.size())
+        mesh.normals.clear();
+
+    if(mesh.text_coords.size() != mesh.vertexes.size())
+        mesh.text_coords.clear();
+
+    std::cout << in_fn << ": " << mesh.triangle_count() << " triangles, "
+              << VERTEX_CACHE_SIZE << " entry FIFO cache\n"
+              << "  " << std::left << std::setw(20) << "" << std::right
+              << std::setw(8) << "ACMR" << std::setw(8) << "ATVR" << std::setw(12) << "vertexes" << '\n';
+
+    if(mesh.is_indexed())
+        print_stats("input", mesh.indexes, mesh.vertexes.size());
+    else{
+        //a triangle soup transforms every vertex it draws
+        vector<uint32_t> soup(mesh.vertexes.size());
+        std::iota(soup.begin(), soup.end(), 0);
+
+        print_stats("input", soup, mesh.vertexes.size());
+    }
+
+    weld(mesh);
+    print_stats("welded", mesh.indexes, mesh.vertexes.size());
+
+    mesh.indexes = optimize_vertex_cache(mesh.indexes, mesh.vertexes.size());
+    print_stats("vertex cache", mesh.indexes, mesh.vertexes.size());
+
+    if(options.overdraw){
+        mesh.indexes = optimize_overdraw(mesh.indexes, mesh);
+        print_stats("overdraw", mesh.indexes, mesh.vertexes.size());
+    }
+
+    //meshlets of the input no longer match the reordered triangles
+    mesh.meshlets.clear();
+
+    if(options.meshlet_triangles > 0){
+        build_meshlets(mesh, options.meshlet_vertexes, options.meshlet_triangles);
+        print_stats("meshlets", mesh.indexes, mesh.vertexes.size());
+    }
+
+    optimize_vertex_fetch(mesh);
+
+    return binary_writer(out_fn, mesh, options);
+}
@@ -0,0 +1,145 @@
+#include "options.hpp"
+#include "filters.hpp"
+
+using std::string;
+using std::vector;
+using std::tuple;
+
+
+
+Options::Options() :
+    binary(false), single_precision(false), indexed(false), threads(0), force(false), lods(1), tolerance(0.0), overdraw(false), quantize(0), memory(0),
+    meshlet_vertexes(0), meshlet_triangles(0), max_error(0.0) {}
+
+
+
+//split the options from the positional arguments, which keep their relative order
+//options not given keep the values they have in options
+tuple<ErrorCode, Options, vector<string>>
+parse_options(int size, const string args[], Options options){
+
+    vector<string> positional {};
+
+    for(int i{}; i < size; ++i){
+
+        const string &arg { args[i] };
+
+        if(arg.rfind("--", 0) != 0){
+            positional.push_back(arg);
+            continue;
+        }
+
+        if(arg == "--binary")
+            options.binary = true;
+
+        else if(arg == "--float"){
+            options.binary = true;
+            options.single_precision = true;
+        }
+
+        else if(arg == "--indexed"){
+            options.binary = true;
+            options.indexed = true;
+        }
+
+        else if(arg == "--force")
+            options.force = true;
+
+        else if(arg == "--overdraw")
+            options.overdraw = true;
+
+        else if(arg == "--threads"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const int threads { string_to_uint(args[++i]) };
+            if(threads < 1)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.threads = static_cast<unsigned>(threads);
+        }
+
+        else if(arg == "--lods"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const int lods { string_to_uint(args[++i]) };
+            if(lods < 1)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.lods = static_cast<unsigned>(lods);
+        }
+
+        else if(arg == "--quantize"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const int bits { string_to_uint(args[++i]) };
+            if(bits != 8 && bits != 16)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.binary = true;
+            options.quantize = static_cast<unsigned>(bits);
+        }
+
+        else if(arg == "--memory"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const int memory { string_to_uint(args[++i]) };
+            if(memory < 1)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.memory = static_cast<unsigned>(memory);
+        }
+
+        else if(arg == "--meshlets"){
+
+            if(i + 2 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const int vertexes { string_to_uint(args[++i]) };
+            const int triangles { string_to_uint(args[++i]) };
+            if(vertexes < 3 || triangles < 1)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.binary = true;
+            options.indexed = true;
+            options.meshlet_vertexes = static_cast<unsigned>(vertexes);
+            options.meshlet_triangles = static_cast<unsigned>(triangles);
+        }
+
+        else if(arg == "--tolerance"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const double tolerance { string_to_double(args[++i], -1.0) };
+            if(tolerance <= 0.0)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.tolerance = tolerance;
+        }
+
+        else if(arg == "--max-error"){
+
+            if(i + 1 >= size)
+                return { ErrorCode::not_enough_args, options, std::move(positional) };
+
+            const double max_error { string_to_double(args[++i], -1.0) };
+            if(max_error <= 0.0)
+                return { ErrorCode::invalid_argument, options, std::move(positional) };
+
+            options.max_error = max_error;
+        }
+
+        else
+            return { ErrorCode::invalid_argument, options, std::move(positional) };
+    }
+
+    return { ErrorCode::success, options, std::move(positional) };
+}
@@ -0,0 +1,72 @@
+#include "parallel.hpp"
+
+using std::vector;
+using std::thread;
+
+
+
+template<typename T>
+static void move_append(vector<T> &dst, vector<T> &src){
+    dst.insert(dst.end(), src.begin(), src.end());
+    vector<T>{}.swap(src);
+}
+
+static Mesh concatenate(vector<Mesh> &meshes){
+
+    size_t num_of_vertexes {};
+    for(auto const& m : meshes)
+        num_of_vertexes += m.vertexes.size();
+
+    Mesh res {};
+    res.vertexes.reserve(num_of_vertexes);
+    res.normals.reserve(num_of_vertexes);
+    res.text_coords.reserve(num_of_vertexes);
+
+    for(auto& m : meshes){
+        move_append(res.vertexes, m.vertexes);
+        move_append(res.normals, m.normals);
+        move_append(res.text_coords, m.text_coords);
+    }
+
+    return res;
+}
+
+Mesh generate_parallel(size_t count, unsigned threads, const RangeGenerator &generate){
+
+    if(threads < 1)
+        threads = default_thread_count();
+
+    if(count < threads)
+        threads = static_cast<unsigned>(count > 0 ? count : 1);
+
+    if(threads == 1){
+        Mesh mesh {};
+        generate(mesh, 0, count);
+        return mesh;
+    }
+
+    vector<Mesh> partial_meshes(threads);
+    vector<thread> workers {};
+    workers.reserve(threads);
+
+    for(unsigned t{}; t < threads; ++t){
+
+        const size_t begin { count * t / threads };
+        const size_t end { count * (t + 1) / threads };
+
+        workers.emplace_back(generate, std::ref(partial_meshes[t]), begin, end);
+    }
+
+    for(auto& w : workers)
+        w.join();
+
+    return concatenate(partial_meshes);
+}
+
+unsigned default_thread_count(){
+
+    //may be 0 if it isn't computable
+    const unsigned n { thread::hardware_concurrency() };
+
+    return n > 0 ? n : 1;
+}
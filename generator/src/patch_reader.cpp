@@ -0,0 +1,176 @@
+#include "patch_reader.hpp"
+#include "mapped_file.hpp"
+#include "text_scanner.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using std::string;
+using std::vector;
+using std::array;
+using std::tuple;
+
+
+
+using PatchIndexes = vector<array<unsigned, NUM_OF_PATCH_POINTS>>;
+
+//the shortest a patch line can be: single digit indexes, commas and a line break
+static constexpr size_t MIN_PATCH_LINE { 2 * NUM_OF_PATCH_POINTS };
+
+//report where filename is malformed and what was expected there
+static tuple<ErrorCode, PatchIndexes, vector<CartPoint3d>>
+syntax_error(const string &filename, size_t line, size_t column, const string &expected){
+
+    //a single write, so that messages of concurrent batch jobs don't interleave
+    std::ostringstream message {};
+    message << "generator: " << filename << ':' << line << ':' << column << ": " << expected << '\n';
+    std::cerr << message.str();
+
+    return { ErrorCode::invalid_file_formatting, PatchIndexes{}, vector<CartPoint3d>{} };
+}
+
+static tuple<ErrorCode, PatchIndexes, vector<CartPoint3d>>
+syntax_error(const string &filename, const TextScanner &scanner, const string &expected){
+    return syntax_error(filename, scanner.line(), scanner.column(), expected);
+}
+
+tuple<ErrorCode, PatchIndexes, vector<CartPoint3d>>
+read_patch_file(const string &filename){
+
+    const MappedFile file { filename };
+
+    if(!file.is_open())
+        return { ErrorCode::io_error, PatchIndexes{}, vector<CartPoint3d>{} };
+
+    TextScanner scanner { file.data(), file.end() };
+
+
+
+    uint64_t num_of_patches {};
+
+    scanner.skip_whitespace();
+    if(!scanner.read_uint(num_of_patches, std::numeric_limits<uint32_t>::max()))
+        return syntax_error(filename, scanner, "expected the number of patches");
+
+    PatchIndexes patch_indexes {};
+
+    //the count alone can't be trusted to size anything, unlike the file itself
+    patch_indexes.reserve(std::min<uint64_t>(num_of_patches, file.size() / MIN_PATCH_LINE));
+
+    //the largest index, checked against the number of control points once it is known
+    uint64_t max_index {};
+    size_t max_index_line {}, max_index_column {};
+
+    while(patch_indexes.size() < num_of_patches){
+
+        scanner.skip_blanks();
+
+        if(scanner.skip_line_break())
+            continue;
+
+        if(scanner.at_end()){
+            std::ostringstream expected {};
+            expected << "expected " << num_of_patches << " patches, found " << patch_indexes.size();
+            return syntax_error(filename, scanner, expected.str());
+        }
+
+        array<unsigned, NUM_OF_PATCH_POINTS> patch {};
+
+        for(size_t i{}; i < NUM_OF_PATCH_POINTS; ++i){
+
+            if(i > 0){
+                scanner.skip_blanks();
+
+                if(!scanner.accept(',')){
+                    std::ostringstream expected {};
+                    expected << "expected ',' and " << NUM_OF_PATCH_POINTS - i << " more control point indexes";
+                    return syntax_error(filename, scanner, expected.str());
+                }
+            }
+
+            scanner.skip_blanks();
+
+            const size_t line { scanner.line() };
+            const size_t column { scanner.column() };
+
+            uint64_t index {};
+            if(!scanner.read_uint(index, std::numeric_limits<unsigned>::max()))
+                return syntax_error(filename, scanner, "expected a control point index");
+
+            if(index > max_index || patch_indexes.empty()){
+                max_index = index;
+                max_index_line = line;
+                max_index_column = column;
+            }
+
+            patch[i] = static_cast<unsigned>(index);
+        }
+
+        scanner.skip_blanks();
+
+        if(!scanner.at_end() && !scanner.skip_line_break()){
+            std::ostringstream expected {};
+            expected << "expected the end of the patch after " << NUM_OF_PATCH_POINTS << " indexes";
+            return syntax_error(filename, scanner, expected.str());
+        }
+
+        patch_indexes.push_back(patch);
+    }
+
+
+
+    uint64_t num_of_ctrl_points {};
+
+    scanner.skip_whitespace();
+    if(!scanner.read_uint(num_of_ctrl_points, std::numeric_limits<uint32_t>::max()))
+        return syntax_error(filename, scanner, "expected the number of control points");
+
+    if(patch_indexes.size() > 0 && max_index >= num_of_ctrl_points){
+        std::ostringstream expected {};
+        expected << "expected a control point index below " << num_of_ctrl_points << ", found " << max_index;
+        return syntax_error(filename, max_index_line, max_index_column, expected.str());
+    }
+
+    vector<CartPoint3d> ctrl_points {};
+    ctrl_points.reserve(std::min<uint64_t>(num_of_ctrl_points, file.size() / 6));
+
+    while(ctrl_points.size() < num_of_ctrl_points){
+
+        array<double, 3> coords {};
+
+        for(size_t c{}; c < 3; ++c){
+
+            scanner.skip_whitespace();
+
+            //coordinates are separated by ',' (or ';', as in text meshes)
+            if(c > 0){
+                if(!scanner.accept(',') && !scanner.accept(';'))
+                    return syntax_error(filename, scanner, "expected ',' between coordinates");
+
+                scanner.skip_whitespace();
+            }
+
+            if(!scanner.read_double(coords[c])){
+
+                if(scanner.at_end()){
+                    std::ostringstream expected {};
+                    expected << "expected " << num_of_ctrl_points << " control points, found " << ctrl_points.size();
+                    return syntax_error(filename, scanner, expected.str());
+                }
+
+                return syntax_error(filename, scanner, "expected a coordinate");
+            }
+        }
+
+        ctrl_points.emplace_back(coords[0], coords[1], coords[2]);
+    }
+
+
+
+    return {
+        ErrorCode::success,
+        std::move(patch_indexes),
+        std::move(ctrl_points)
+    };
+}
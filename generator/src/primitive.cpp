@@ -1,4 +1,24 @@
 #include "primitive.hpp"
+#include "mesh.hpp"
+#include "mesh_writer.hpp"
+#include "parallel.hpp"
+#include "bernstein.hpp"
+#include "patch_reader.hpp"
+#include "adaptive_bezier.hpp"
+#include "trig_table.hpp"
+#include "optimize.hpp"
+#include "simplify.hpp"
+#include "stream.hpp"
+#include "batch.hpp"
+#include "cache.hpp"
+#include "lod.hpp"
+
+#include <algorithm>
+
+#ifdef BENCH
+#include <chrono>
+#include <iostream>
+#endif
 
 using std::string;
 using std::vector;
@@ -13,19 +33,26 @@ enum Primitive {
     cone,
     torus,
     bezier,
+    icosphere,
+    cubesphere,
+    optimize,
+    simplify,
     __invalid,
 };
 
 
 
-static constexpr size_t NUM_OF_PATCH_POINTS { 16 };
-
 static constexpr int PLANE_ARGS  { 5 };
 static constexpr int BOX_ARGS    { 5 };
 static constexpr int CONE_ARGS   { 7 };
 static constexpr int SPHERE_ARGS { 6 };
 static constexpr int TORUS_ARGS  { 7 };
 static constexpr int BEZIER_ARGS { 5 };
+static constexpr int ICOSPHERE_ARGS  { 5 };
+static constexpr int CUBESPHERE_ARGS { 5 };
+static constexpr int OPTIMIZE_ARGS   { 4 };
+static constexpr int SIMPLIFY_ARGS   { 5 };
+static constexpr size_t BATCH_ARGS { 3 };
 
 
 
@@ -38,6 +65,10 @@ static Primitive from_string(const string &str){
         { "cone",   Primitive::cone   },
         { "torus",  Primitive::torus  },
         { "bezier", Primitive::bezier },
+        { "icosphere",  Primitive::icosphere  },
+        { "cubesphere", Primitive::cubesphere },
+        { "optimize",   Primitive::optimize   },
+        { "simplify",   Primitive::simplify   },
     };
 
     Primitive p { Primitive::__invalid };
@@ -50,419 +81,366 @@ static Primitive from_string(const string &str){
 
 
 
-static
-tuple<ErrorCode, vector<array<unsigned, NUM_OF_PATCH_POINTS>>, vector<CartPoint3d>>
-read_patch_file(const string &filename){
-
-    std::ifstream input_file{};
-    input_file.open(filename, std::ios::in);
-
-    vector<array<unsigned, NUM_OF_PATCH_POINTS>> patch_indexes {};
-    vector<CartPoint3d> ctrl_points {};
-
-    if(!input_file.is_open())
-        return {
-            ErrorCode::io_error,
-            std::move(patch_indexes),
-            std::move(ctrl_points)
-        };
-
+static void reserve_vertexes(Mesh &mesh, size_t num_of_vertexes){
+    mesh.vertexes.reserve(num_of_vertexes);
+    mesh.normals.reserve(num_of_vertexes);
+    mesh.text_coords.reserve(num_of_vertexes);
+}
 
+/**
+ * The value reached by subtracting step from start count times
+ * Writers which walk a grid by accumulating a step use it to start a range midway
+ * with the exact same value the serial loop would have reached
+ */
+static double replay_steps(double start, double step, int count){
 
-    size_t num_of_patches {};
+    for(int i{}; i < count; ++i)
+        start -= step;
 
-    if(!(input_file >> num_of_patches))
-        return {
-            ErrorCode::invalid_file_formatting,
-            std::move(patch_indexes),
-            std::move(ctrl_points)
-        };
-
-    patch_indexes.reserve(num_of_patches);
+    return start;
+}
 
+//tesselate the patches in [first_patch, last_patch), appending them to mesh
+static void bezier_tesselator(Mesh &mesh,
+                              const vector<array<unsigned, NUM_OF_PATCH_POINTS>> &patch_indexes,
+                              const vector<CartPoint3d> &ctrl_points,
+                              const BernsteinTable &table,
+                              size_t first_patch, size_t last_patch){
 
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
 
-    size_t patch_count {};
-    string line {};
+    const size_t samples { table.size() };
 
-    while(patch_count < num_of_patches && std::getline(input_file, line)){
+    const size_t vertexes_per_patch { 6 * (samples - 1) * (samples - 1) };
+    vertexes.reserve(vertexes_per_patch * (last_patch - first_patch));
+    normals.reserve(vertexes_per_patch * (last_patch - first_patch));
+    text_coords.reserve(vertexes_per_patch * (last_patch - first_patch));
 
-        if(line == "")
-            continue;
+    /**
+     * Only two rows of samples are kept at a time:
+     * the quads between them are written out before moving on to the next row
+     */
+    PatchRow prev_row { table };
+    PatchRow curr_row { table };
 
-        array<unsigned, NUM_OF_PATCH_POINTS> elem {};
-        auto elem_iter { elem.begin() };
+    for(size_t p { first_patch }; p < last_patch; ++p){
 
-        size_t end{}, start{};
+        array<CartPoint3d, NUM_OF_PATCH_POINTS> points {};
+        for(size_t i{}; i < NUM_OF_PATCH_POINTS; ++i)
+            points[i] = ctrl_points[patch_indexes[p][i]];
 
-        do{
-            end = line.find(',', start);
+        evaluate_patch_row(points, table, 0, prev_row);
 
-            const int index { string_to_uint(line.substr(start, end - start)) };
-            if(index < 0)
-                return {
-                    ErrorCode::invalid_file_formatting,
-                    std::move(patch_indexes),
-                    std::move(ctrl_points)
-                };
+        for(size_t i{}; i < samples - 1; ++i){
 
-            *elem_iter = static_cast<unsigned>(index);
-            ++elem_iter;
+            evaluate_patch_row(points, table, i + 1, curr_row);
 
-            if(end < std::string::npos)
-                start = end + 1;
-        }
-        while(end < std::string::npos && elem_iter != elem.end());
+            const double u_time { table.time_at(i) };
+            const double next_u_time { table.time_at(i + 1) };
 
-        if(elem_iter != elem.end())
-            return {
-                ErrorCode::invalid_file_formatting,
-                std::move(patch_indexes),
-                std::move(ctrl_points)
-            };
+            for(size_t j{}; j < samples - 1; ++j){
 
-        patch_indexes.push_back(std::move(elem));
-        ++patch_count;
-    }
+                const double v_time { table.time_at(j) };
+                const double next_v_time { table.time_at(j + 1) };
 
-    if(patch_count != num_of_patches)
-        return {
-            ErrorCode::invalid_file_formatting,
-            std::move(patch_indexes),
-            std::move(ctrl_points)
-        };
+                vertexes << prev_row.position(j)
+                         << prev_row.position(j + 1)
+                         << curr_row.position(j);
 
+                vertexes << curr_row.position(j + 1)
+                         << curr_row.position(j)
+                         << prev_row.position(j + 1);
 
-    size_t num_of_ctrl_points {};
 
-    if(!(input_file >> num_of_ctrl_points))
-        return {
-            ErrorCode::invalid_file_formatting,
-            std::move(patch_indexes),
-            std::move(ctrl_points)
-        };
+                normals << prev_row.normal(j)
+                        << prev_row.normal(j + 1)
+                        << curr_row.normal(j);
 
-    ctrl_points.reserve(num_of_ctrl_points);
+                normals << curr_row.normal(j + 1)
+                        << curr_row.normal(j)
+                        << prev_row.normal(j + 1);
 
-    CartPoint3d point {};
 
-    for(unsigned i {}; i < num_of_ctrl_points && (input_file >> point); ++i)
-        ctrl_points.push_back(point);
-
-    if(ctrl_points.size() != num_of_ctrl_points)
-        return {
-            ErrorCode::invalid_file_formatting,
-            std::move(patch_indexes),
-            std::move(ctrl_points)
-        };
+                const CartPoint2d t1 { u_time, v_time };
+                const CartPoint2d t2 { u_time, next_v_time };
+                const CartPoint2d t3 { next_u_time, v_time };
+                const CartPoint2d t4 { next_u_time, next_v_time };
 
+                text_coords << t1 << t2 << t3;
+                text_coords << t4 << t3 << t2;
+            }
 
-    return {
-        ErrorCode::success,
-        std::move(patch_indexes),
-        std::move(ctrl_points)
-    };
+            std::swap(prev_row, curr_row);
+        }
+    }
 }
 
-static ErrorCode bezier_writer(const string &out_fn, const string &in_fn, unsigned tesselation_level){
+static ErrorCode bezier_writer(const string &out_fn, const string &in_fn,
+                               unsigned tesselation_level, const Options &options){
+
+#ifdef BENCH
+    const auto parse_begin_time { std::chrono::steady_clock::now() };
+#endif
 
     auto const& [code, patch_indexes, ctrl_points] { read_patch_file(in_fn) };
     if(code != ErrorCode::success)
         return code;
 
+#ifdef BENCH
+    const std::chrono::duration<double> parse_elapsed { std::chrono::steady_clock::now() - parse_begin_time };
+
+    std::cout << "bezier: " << patch_indexes.size() << " patches, " << ctrl_points.size()
+              << " control points parsed in " << parse_elapsed.count() * 1000.0 << " ms\n";
+#endif
+
     /**
      * Input part is done, needed structures are created
      * Now it's time to treat them accordingly and take care of the output
+     *
+     * Patches don't depend on one another, hence they are split among the workers
      */
 
-    std::ofstream vertexes_file{};
-    vertexes_file.open(out_fn, std::ios::out | std::ios::trunc);
+#ifdef BENCH
+    const auto begin_time { std::chrono::steady_clock::now() };
+#endif
 
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(out_fn), std::ios::out | std::ios::trunc);
+    /* each side of a patch is split into tesselation_level segments, hence sampled
+     * tesselation_level + 1 times, from 0 to 1 inclusive, so that patches sharing
+     * an edge sample it at the same points and are "stitched" together
+     */
+    const double time_step { 1.0 / static_cast<double>(tesselation_level) };
+    const BernsteinTable table { tesselation_level + 1, time_step };
 
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(out_fn), std::ios::out | std::ios::trunc);
+    const RangeGenerator uniform {
+        [&patches = patch_indexes, &points = ctrl_points, &table]
+        (Mesh &m, size_t begin, size_t end){
+            bezier_tesselator(m, patches, points, table, begin, end);
+        }
+    };
 
-    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
-        return ErrorCode::io_error;
+    //the tesselation level caps the number of segments per side of adaptive patches
+    const RangeGenerator adaptive {
+        [&patches = patch_indexes, &points = ctrl_points, &options, tesselation_level]
+        (Mesh &m, size_t begin, size_t end){
+            for(size_t p { begin }; p < end; ++p){
 
-    /* tesselation_level is incremented
-     * in order for all the various patches
-     * to be "stitched" together
-     */
-    const double time_step { 1.0 / static_cast<double>(tesselation_level++) };
+                array<CartPoint3d, NUM_OF_PATCH_POINTS> patch_points {};
+                for(size_t i{}; i < NUM_OF_PATCH_POINTS; ++i)
+                    patch_points[i] = points[patches[p][i]];
 
-    const Matrix<double, 4, 4> coeffs_matrix {
-        array{ -1.0,  3.0, -3.0, 1.0 },
-        array{  3.0, -6.0,  3.0, 0.0 },
-        array{ -3.0,  3.0,  0.0, 0.0 },
-        array{  1.0,  0.0,  0.0, 0.0 }
-    };
-    const Matrix<double, 4, 4> t_coeffs_matrix { coeffs_matrix.transpose() };
-
-    for(auto const& indexes_array : patch_indexes){
-
-        vector<vector<CartPoint3d>> vertex_matrix {};
-        vertex_matrix.reserve(tesselation_level);
-
-        vector<vector<CartPoint3d>> normals_matrix {};
-        normals_matrix.reserve(tesselation_level);
-
-        vector<vector<CartPoint2d>> text_matrix {};
-        text_matrix.reserve(tesselation_level);
-
-
-        auto iter { indexes_array.begin() };
-        const Matrix<CartPoint3d, 4, 4> point_matrix {
-            array{
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++]
-            },
-            array{
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++]
-            },
-            array{
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++]
-            },
-            array{
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter++],
-                ctrl_points[*iter]
+                tesselate_adaptive_patch(m, patch_points, options.tolerance, tesselation_level);
             }
-        };
+        }
+    };
 
-        const Matrix<CartPoint3d, 4, 4> inner_partial_matrix {
-            coeffs_matrix * point_matrix * t_coeffs_matrix
-        };
+    const RangeGenerator &generate { options.tolerance > 0.0 ? adaptive : uniform };
 
-        for(unsigned u{}; u < tesselation_level; ++u){
+    if(options.memory > 0)
+        return stream_writer(out_fn, patch_indexes.size(), options, generate);
 
-            vector<CartPoint3d> vertex_row {};
-            vertex_row.reserve(tesselation_level);
+    Mesh mesh { generate_parallel(patch_indexes.size(), options.threads, generate) };
 
-            vector<CartPoint3d> normals_row {};
-            normals_row.reserve(tesselation_level);
+#ifdef BENCH
+    const std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - begin_time };
+    const double triangles { static_cast<double>(mesh.triangle_count()) };
 
-            vector<CartPoint2d> text_row {};
-            text_row.reserve(tesselation_level);
+    std::cout << "bezier: " << mesh.triangle_count() << " triangles in "
+              << elapsed.count() * 1000.0 << " ms ("
+              << triangles / elapsed.count() / 1e6 << " Mtriangles/s)\n";
+#endif
 
+    return write_mesh(out_fn, mesh, options);
+}
 
-            const double u_time { time_step * static_cast<double>(u) };
+//the point at radius whose zOx and yOp angles have the given sines and cosines (as in polar_to_cart)
+static inline CartPoint3d from_angles(double radius, double sin_zOx, double cos_zOx,
+                                      double sin_yOp, double cos_yOp){
+    return {
+        radius * sin_zOx * sin_yOp,
+        radius * cos_yOp,
+        radius * cos_zOx * sin_yOp
+    };
+}
 
-            const Matrix<double, 1, 4> u_vector { //Bernstein polynomials definiton
-                array{
-                    u_time * u_time * u_time,
-                    u_time * u_time,
-                    u_time,
-                    1.0
-                }
-            };
+/**
+ * Generate the slices in [first_slice, last_slice) of the torus, appending them to mesh
+ *
+ * The tube is swept by the angle phi, running from 90 (top) down to -90 (bottom)
+ * over the stacks: a point of the tube's cross section lies diff_radius * sin(phi) away
+ * from the tube's centre line and diff_radius * cos(phi) above it.
+ * Its mirror image below the xOz plane completes the tube.
+ */
+static void torus_slices(Mesh &mesh, int out_radius, int in_radius, int slices, int stacks,
+                         const TrigTable &zOx_table, const TrigTable &phi_table,
+                         int first_slice, int last_slice){
 
-            const Matrix<double, 1, 4> u_vector_deriv {
-                array{
-                    3.0 * u_time * u_time,
-                    2.0 * u_time,
-                    1.0,
-                    0.0
-                }
-            };
+    reserve_vertexes(mesh, 12 * static_cast<size_t>(stacks * (last_slice - first_slice)));
 
-            for(unsigned v{}; v < tesselation_level; ++v){
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
 
-                const double v_time { time_step * static_cast<double>(v) };
+    const double diff_radius { static_cast<double>(out_radius - in_radius) / 2.0 };
+    const double center_radius { static_cast<double>(in_radius) + diff_radius };
 
-                const Matrix<double, 4, 1> v_vector {
-                    array{ v_time * v_time * v_time},
-                    array{ v_time * v_time },
-                    array{ v_time },
-                    array{ 1.0 }
-                };
+    const double t_step { 1.0 / static_cast<double>(stacks) };
+    const double s_step { 1.0 / static_cast<double>(slices) };
 
-                const Matrix<double, 4, 1> v_vector_deriv {
-                    array{ 3.0 * v_time * v_time },
-                    array{ 2.0 * v_time },
-                    array{ 1.0 },
-                    array{ 0.0 }
-                };
+    const auto point {
+        [&](size_t sl, size_t st){
+            const double ring_radius { center_radius + diff_radius * phi_table.sin(st) };
+            return CartPoint3d {
+                ring_radius * zOx_table.sin(sl),
+                diff_radius * phi_table.cos(st),
+                ring_radius * zOx_table.cos(sl)
+            };
+        }
+    };
 
-                const Matrix<CartPoint3d, 1, 1> vertex {
-                    u_vector * inner_partial_matrix * v_vector
-                };
+    const auto normal {
+        [&](size_t sl, size_t st){
+            return from_angles(1.0, zOx_table.sin(sl), zOx_table.cos(sl), phi_table.sin(st), phi_table.cos(st));
+        }
+    };
 
-                const Matrix<CartPoint3d, 1, 1> tangent1 {
-                    u_vector_deriv * inner_partial_matrix * v_vector
-                };
+    const auto mirror { [](const CartPoint3d &p){ return CartPoint3d { p.x, -p.y, p.z }; } };
 
-                const Matrix<CartPoint3d, 1, 1> tangent2 {
-                    u_vector * inner_partial_matrix * v_vector_deriv
-                };
+    for(size_t sl { static_cast<size_t>(first_slice) }; sl < static_cast<size_t>(last_slice); ++sl)
 
+        for(size_t st{}; st < static_cast<size_t>(stacks); ++st){
 
-                vertex_row.push_back(vertex.at(0, 0));
-                normals_row.push_back(
-                    cross_product(
-                        tangent2.at(0, 0),
-                        tangent1.at(0, 0)
-                    ).normalize()
-                );
-                text_row.push_back( { u_time, v_time } );
-            }
+            const CartPoint3d p1 { point(sl, st) };
+            const CartPoint3d p2 { point(sl + 1, st) };
+            const CartPoint3d p3 { point(sl, st + 1) };
+            const CartPoint3d p4 { point(sl + 1, st + 1) };
 
-            vertex_matrix.push_back(std::move(vertex_row));
-            normals_matrix.push_back(std::move(normals_row));
-            text_matrix.push_back(std::move(text_row));
-        }
+            vertexes << p1 << p2 << p3;
+            vertexes << p2 << p4 << p3;
 
-        for(unsigned i{}; i < static_cast<size_t>(tesselation_level - 1); ++i)
-            for(unsigned j{}; j < static_cast<size_t>(tesselation_level - 1); ++j){
+            vertexes << mirror(p1) << mirror(p3) << mirror(p2);
+            vertexes << mirror(p3) << mirror(p4) << mirror(p2);
 
-                vertexes_file << vertex_matrix[i][j]
-                              << vertex_matrix[i][j + 1]
-                              << vertex_matrix[i + 1][j];
 
-                vertexes_file << vertex_matrix[i + 1][j + 1]
-                              << vertex_matrix[i + 1][j]
-                              << vertex_matrix[i][j + 1];
+            const CartPoint3d normal1 { normal(sl, st) };
+            const CartPoint3d normal2 { normal(sl + 1, st) };
+            const CartPoint3d normal3 { normal(sl, st + 1) };
+            const CartPoint3d normal4 { normal(sl + 1, st + 1) };
 
+            normals << normal1 << normal2 << normal3;
+            normals << normal2 << normal4 << normal3;
 
-                normals_file << normals_matrix[i][j]
-                             << normals_matrix[i][j + 1]
-                             << normals_matrix[i + 1][j];
+            normals << mirror(normal1) << mirror(normal3) << mirror(normal2);
+            normals << mirror(normal3) << mirror(normal4) << mirror(normal2);
 
-                normals_file << normals_matrix[i + 1][j + 1]
-                             << normals_matrix[i + 1][j]
-                             << normals_matrix[i][j + 1];
 
+            const CartPoint2d t1 {
+                s_step * static_cast<double>(sl),
+                0.5 + t_step * static_cast<double>(st)
+            };
+            const CartPoint2d t2 {
+                s_step * static_cast<double>(sl + 1),
+                0.5 + t_step * static_cast<double>(st)
+            };
+            const CartPoint2d t3 {
+                s_step * static_cast<double>(sl),
+                0.5 + t_step * static_cast<double>(st + 1)
+            };
+            const CartPoint2d t4 {
+                s_step * static_cast<double>(sl + 1),
+                0.5 + t_step * static_cast<double>(st + 1)
+            };
 
-                text_file << text_matrix[i][j]
-                          << text_matrix[i][j + 1]
-                          << text_matrix[i + 1][j];
+            text_coords << t1 << t2 << t3;
+            text_coords << t2 << t4 << t3;
 
-                text_file << text_matrix[i + 1][j + 1]
-                          << text_matrix[i + 1][j]
-                          << text_matrix[i][j + 1];
-            }
-    }
+            const CartPoint2d neg_t1 { t1.x, 1.0 - t1.y };
+            const CartPoint2d neg_t2 { t2.x, 1.0 - t2.y };
+            const CartPoint2d neg_t3 { t3.x, 1.0 - t3.y };
+            const CartPoint2d neg_t4 { t4.x, 1.0 - t4.y };
 
-    return ErrorCode::success;
+            text_coords << neg_t1 << neg_t3 << neg_t2;
+            text_coords << neg_t3 << neg_t4 << neg_t2;
+        }
 }
 
 static ErrorCode torus_writer(const string &filename, int out_radius,
-                              int in_radius, int slices, int stacks){
-
-    std::ofstream vertexes_file{};
-    vertexes_file.open(filename, std::ios::out | std::ios::trunc);
-
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(filename), std::ios::out | std::ios::trunc);
-
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(filename), std::ios::out | std::ios::trunc);
-
-    if(!vertexes_file.is_open() || !normals_file.is_open())
-        return ErrorCode::io_error;
+                              int in_radius, int slices, int stacks, const Options &options){
 
     const angle_t zOx_delta { 360.0 / static_cast<angle_t>(slices) };
     const angle_t yOp_delta { 180.0 / static_cast<angle_t>(stacks) };
-    const double diff_radius { static_cast<double>(out_radius - in_radius) / 2.0 };
 
-    const double t_step { 1.0 / static_cast<double>(stacks) };
-    const double s_step { 1.0 / static_cast<double>(slices) };
+    const TrigTable zOx_table { static_cast<size_t>(slices), 0.0, zOx_delta };
+    const TrigTable phi_table { static_cast<size_t>(stacks), 90.0, -yOp_delta };
 
-    for(int sl{}; sl < slices; ++sl)
+    return generate_mesh(
+        filename,
+        static_cast<size_t>(slices),
+        options,
+        [&](Mesh &m, size_t begin, size_t end){
+            torus_slices(m, out_radius, in_radius, slices, stacks, zOx_table, phi_table,
+                         static_cast<int>(begin), static_cast<int>(end));
+        }
+    );
+}
 
-        for(int st{}; st < stacks; ++st){
+/**
+ * Generate the slices in [first_slice, last_slice) of the sphere, appending them to mesh
+ * Each stack of the upper half is mirrored below the xOz plane
+ */
+static void sphere_slices(Mesh &mesh, int radius, int slices, int stacks,
+                          const TrigTable &zOx_table, const TrigTable &yOp_table,
+                          int first_slice, int last_slice){
 
-            angle_t bottom_yOp { 90.0 - yOp_delta * static_cast<angle_t>(st) };
-            angle_t top_yOp { 90.0 - yOp_delta * static_cast<angle_t>(st + 1) };
-            angle_t bottom_zOx_offset {};
-            angle_t top_zOx_offset {};
-
-            /**
-             * If yOp ever becomes negative, rotate zOx by 180
-             * and negate yOp
-             * That way the same point is
-             * represented by this combo of angles
-             */
-
-            if(bottom_yOp < 0.0){
-                bottom_yOp *= -1.0;
-                bottom_zOx_offset = 180.0;
-            }
+    reserve_vertexes(mesh, 12 * static_cast<size_t>(stacks / 2 * (last_slice - first_slice)));
 
-            if(top_yOp < 0.0){
-                top_yOp *= -1.0;
-                top_zOx_offset = 180.0;
-            }
-
-            CartPoint3d bottom_starting_p {
-                polar_to_cart( { diff_radius, bottom_zOx_offset, bottom_yOp } )
-            };
-            bottom_starting_p.z += static_cast<angle_t>(in_radius) + diff_radius;
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
 
-            CartPoint3d top_starting_p {
-                polar_to_cart( { diff_radius, top_zOx_offset, top_yOp } )
-            };
-            top_starting_p.z += static_cast<angle_t>(in_radius) + diff_radius;
+    const double radius_d { static_cast<double>(radius) };
 
+    const double t_step { 1.0 / static_cast<double>(stacks) };
+    const double s_step { 1.0 / static_cast<double>(slices) };
 
-            PolarPoint3d p1 {
-                cart_to_polar(bottom_starting_p)
-            };
-            p1.zOx = static_cast<angle_t>(sl) * zOx_delta;
+    //the normal is the direction of the point
+    const auto normal {
+        [&](size_t sl, size_t st){
+            return from_angles(1.0, zOx_table.sin(sl), zOx_table.cos(sl), yOp_table.sin(st), yOp_table.cos(st));
+        }
+    };
 
-            PolarPoint3d p2 {
-                cart_to_polar(bottom_starting_p)
-            };
-            p2.zOx = static_cast<angle_t>(sl + 1) * zOx_delta;
+    const auto scale { [radius_d](const CartPoint3d &n){ return CartPoint3d { radius_d * n.x, radius_d * n.y, radius_d * n.z }; } };
+    const auto mirror { [](const CartPoint3d &p){ return CartPoint3d { p.x, -p.y, p.z }; } };
 
-            PolarPoint3d p3 {
-                cart_to_polar(top_starting_p)
-            };
-            p3.zOx = static_cast<angle_t>(sl) * zOx_delta;
 
-            PolarPoint3d p4 {
-                cart_to_polar(top_starting_p)
-            };
-            p4.zOx = static_cast<angle_t>(sl + 1) * zOx_delta;
+    for(size_t sl { static_cast<size_t>(first_slice) }; sl < static_cast<size_t>(last_slice); ++sl){
 
-            vertexes_file << p1 << p2 << p3;
-            vertexes_file << p2 << p4 << p3;
+        for(size_t st{}; st < static_cast<size_t>(stacks / 2); ++st){
 
-            const PolarPoint3d neg_p1 { p1.radius, p1.zOx, 180 - p1.yOp };
-            const PolarPoint3d neg_p2 { p2.radius, p2.zOx, 180 - p2.yOp };
-            const PolarPoint3d neg_p3 { p3.radius, p3.zOx, 180 - p3.yOp };
-            const PolarPoint3d neg_p4 { p4.radius, p4.zOx, 180 - p4.yOp };
+            const CartPoint3d n1 { normal(sl, st) };
+            const CartPoint3d n2 { normal(sl + 1, st) };
+            const CartPoint3d next_n1 { normal(sl, st + 1) };
+            const CartPoint3d next_n2 { normal(sl + 1, st + 1) };
 
-            vertexes_file << neg_p1 << neg_p3 << neg_p2;
-            vertexes_file << neg_p3 << neg_p4 << neg_p2;
+            const CartPoint3d neg_n1 { mirror(n1) };
+            const CartPoint3d neg_n2 { mirror(n2) };
+            const CartPoint3d neg_next_n1 { mirror(next_n1) };
+            const CartPoint3d neg_next_n2 { mirror(next_n2) };
 
+            vertexes << scale(n1) << scale(n2) << scale(next_n1);
+            vertexes << scale(next_n1) << scale(n2) << scale(next_n2);
 
-            const PolarPoint3d normal1 { 1.0, p1.zOx + bottom_zOx_offset, bottom_yOp };
-            const PolarPoint3d normal2 { 1.0, p2.zOx + bottom_zOx_offset, bottom_yOp };
-            const PolarPoint3d normal3 { 1.0, p3.zOx + top_zOx_offset, top_yOp };
-            const PolarPoint3d normal4 { 1.0, p4.zOx + top_zOx_offset, top_yOp };
+            vertexes << scale(neg_next_n1) << scale(neg_next_n2) << scale(neg_n1);
+            vertexes << scale(neg_n1) << scale(neg_next_n2) << scale(neg_n2);
 
-            normals_file << normal1 << normal2 << normal3;
-            normals_file << normal2 << normal4 << normal3;
 
-            const PolarPoint3d neg_normal1 { 1.0, p1.zOx + bottom_zOx_offset, 180.0 - bottom_yOp };
-            const PolarPoint3d neg_normal2 { 1.0, p2.zOx + bottom_zOx_offset, 180.0 - bottom_yOp };
-            const PolarPoint3d neg_normal3 { 1.0, p3.zOx + top_zOx_offset, 180.0 - top_yOp};
-            const PolarPoint3d neg_normal4 { 1.0, p4.zOx + top_zOx_offset, 180.0 - top_yOp};
+            normals << n1 << n2 << next_n1;
+            normals << next_n1 << n2 << next_n2;
 
-            normals_file << neg_normal1 << neg_normal3 << neg_normal2;
-            normals_file << neg_normal3 << neg_normal4 << neg_normal2;
+            normals << neg_next_n1 << neg_next_n2 << neg_n1;
+            normals << neg_n1 << neg_next_n2 << neg_n2;
 
 
             const CartPoint2d t1 {
@@ -482,137 +460,294 @@ static ErrorCode torus_writer(const string &filename, int out_radius,
                 0.5 + t_step * static_cast<double>(st + 1)
             };
 
-            text_file << t1 << t2 << t3;
-            text_file << t2 << t4 << t3;
+            text_coords << t1 << t2 << t3;
+            text_coords << t3 << t2 << t4;
 
             const CartPoint2d neg_t1 { t1.x, 1.0 - t1.y };
             const CartPoint2d neg_t2 { t2.x, 1.0 - t2.y };
             const CartPoint2d neg_t3 { t3.x, 1.0 - t3.y };
             const CartPoint2d neg_t4 { t4.x, 1.0 - t4.y };
 
-            text_file << neg_t1 << neg_t3 << neg_t2;
-            text_file << neg_t3 << neg_t4 << neg_t2;
+            text_coords << neg_t3 << neg_t4 << neg_t1;
+            text_coords << neg_t1 << neg_t4 << neg_t2;
+        }
+    }
+}
+
+static ErrorCode sphere_writer(const string &filename, int radius, int slices, int stacks,
+                               const Options &options){
+
+    const angle_t zOx_delta { 360.0 / static_cast<angle_t>(slices) };
+    const angle_t yOp_delta { 90.0 / static_cast<angle_t>(stacks / 2) };
+
+    //yOp goes from the equator up to the north pole
+    const TrigTable zOx_table { static_cast<size_t>(slices), 0.0, zOx_delta };
+    const TrigTable yOp_table { static_cast<size_t>(stacks / 2), 90.0, -yOp_delta };
+
+    return generate_mesh(
+        filename,
+        static_cast<size_t>(slices),
+        options,
+        [&](Mesh &m, size_t begin, size_t end){
+            sphere_slices(m, radius, slices, stacks, zOx_table, yOp_table,
+                          static_cast<int>(begin), static_cast<int>(end));
         }
+    );
+}
+
+/**
+ * Texture coordinates of a triangle of a sphere, given the directions of its vertexes,
+ * mapped as those of the UV sphere: s grows with zOx and t goes from 0 (south pole) to 1
+ *
+ * A triangle straddling the zOx = 0 meridian would otherwise span almost the whole
+ * texture, so its coordinates on the far side are carried past 1 (textures repeat).
+ * A vertex at a pole, where zOx is undefined, takes the s of the other two.
+ */
+static array<CartPoint2d, 3> spherical_text_coords(const array<CartPoint3d, 3> &dirs){
+
+    array<CartPoint2d, 3> res {};
+    array<bool, 3> at_pole {};
+
+    for(size_t i{}; i < 3; ++i){
+
+        const PolarPoint3d p { cart_to_polar(dirs[i]) };
+
+        at_pole[i] = dirs[i].x == 0.0 && dirs[i].z == 0.0;
+        res[i] = { p.zOx / 360.0, 1.0 - p.yOp / 180.0 };
+    }
 
-    return ErrorCode::success;
+    double min_s { 1.0 }, max_s { 0.0 };
+    for(size_t i{}; i < 3; ++i)
+        if(!at_pole[i]){
+            min_s = std::min(min_s, res[i].x);
+            max_s = std::max(max_s, res[i].x);
+        }
+
+    if(max_s - min_s > 0.5)
+        for(size_t i{}; i < 3; ++i)
+            if(!at_pole[i] && res[i].x < 0.5)
+                res[i].x += 1.0;
+
+    for(size_t i{}; i < 3; ++i)
+        if(at_pole[i])
+            res[i].x = (res[(i + 1) % 3].x + res[(i + 2) % 3].x) / 2.0;
+
+    return res;
 }
 
-static ErrorCode sphere_writer(const string &filename, int radius, int slices, int stacks){
+//append the triangle of the sphere of radius whose vertexes have the given directions, facing outwards
+static void sphere_triangle(Mesh &mesh, double radius, const CartPoint3d &d1, CartPoint3d d2, CartPoint3d d3){
 
-    std::ofstream vertexes_file{};
-    vertexes_file.open(filename, std::ios::out | std::ios::trunc);
+    const double ux { d2.x - d1.x }, uy { d2.y - d1.y }, uz { d2.z - d1.z };
+    const double vx { d3.x - d1.x }, vy { d3.y - d1.y }, vz { d3.z - d1.z };
 
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(filename), std::ios::out | std::ios::trunc);
+    const double facing {
+        (uy * vz - uz * vy) * (d1.x + d2.x + d3.x) +
+        (uz * vx - ux * vz) * (d1.y + d2.y + d3.y) +
+        (ux * vy - uy * vx) * (d1.z + d2.z + d3.z)
+    };
 
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(filename), std::ios::out | std::ios::trunc);
+    if(facing < 0.0)
+        std::swap(d2, d3);
 
-    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
-        return ErrorCode::io_error;
+    for(auto const& d : { d1, d2, d3 }){
+        mesh.vertexes << CartPoint3d { radius * d.x, radius * d.y, radius * d.z };
+        mesh.normals << d;
+    }
 
-    const angle_t zOx_delta { 360.0 / static_cast<angle_t>(slices) };
-    const angle_t yOp_delta { 90.0 / static_cast<angle_t>(stacks / 2) };
-    const double radius_d { static_cast<double>(radius) };
+    for(auto const& t : spherical_text_coords({ d1, d2, d3 }))
+        mesh.text_coords << t;
+}
 
-    const double t_step { 1.0 / static_cast<double>(stacks) };
-    const double s_step { 1.0 / static_cast<double>(slices) };
 
 
-    for(int sl{}; sl < slices; ++sl){
+static constexpr size_t ICOSAHEDRON_FACES { 20 };
+static constexpr double GOLDEN_RATIO { 1.6180339887498948482 };
 
-        PolarPoint3d bp1 {
-            radius_d,
-            static_cast<angle_t>(sl) * zOx_delta,
-            90.0
-        };
+static const array<CartPoint3d, 12> ICOSAHEDRON_VERTEXES {{
+    { -1.0,  GOLDEN_RATIO, 0.0 }, {  1.0,  GOLDEN_RATIO, 0.0 },
+    { -1.0, -GOLDEN_RATIO, 0.0 }, {  1.0, -GOLDEN_RATIO, 0.0 },
+    { 0.0, -1.0,  GOLDEN_RATIO }, { 0.0,  1.0,  GOLDEN_RATIO },
+    { 0.0, -1.0, -GOLDEN_RATIO }, { 0.0,  1.0, -GOLDEN_RATIO },
+    {  GOLDEN_RATIO, 0.0, -1.0 }, {  GOLDEN_RATIO, 0.0,  1.0 },
+    { -GOLDEN_RATIO, 0.0, -1.0 }, { -GOLDEN_RATIO, 0.0,  1.0 },
+}};
+
+static const array<array<size_t, 3>, ICOSAHEDRON_FACES> ICOSAHEDRON_TRIANGLES {{
+    { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+    { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+    { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+    { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+}};
+
+/**
+ * Direction of the point of an icosahedron face with the given integer barycentric weights
+ * Vertexes are summed in increasing index order and null weights are skipped,
+ * so that faces sharing an edge compute bitwise equal points on it
+ */
+static CartPoint3d icosphere_direction(const array<size_t, 3> &face, const array<int, 3> &weights){
+
+    array<size_t, 3> order { 0, 1, 2 };
+    std::sort(order.begin(), order.end(), [&face](size_t a, size_t b){ return face[a] < face[b]; });
+
+    CartPoint3d p {};
+
+    for(size_t i : order)
+        if(weights[i] != 0){
+
+            const CartPoint3d &v { ICOSAHEDRON_VERTEXES[face[i]] };
+            const double w { static_cast<double>(weights[i]) };
+
+            p.x += w * v.x;
+            p.y += w * v.y;
+            p.z += w * v.z;
+        }
+
+    return p.normalize();
+}
+
+//generate the faces in [first_face, last_face) of the icosphere, appending them to mesh
+static void icosphere_faces(Mesh &mesh, int radius, int subdivisions, size_t first_face, size_t last_face){
+
+    const int n { subdivisions };
+
+    reserve_vertexes(mesh, 3 * static_cast<size_t>(n * n) * (last_face - first_face));
+
+    for(size_t f { first_face }; f < last_face; ++f){
 
-        PolarPoint3d bp2 {
-            radius_d,
-            static_cast<angle_t>(sl + 1) * zOx_delta,
-            90.0
+        const array<size_t, 3> &face { ICOSAHEDRON_TRIANGLES[f] };
+
+        //the point k of row r lies (r - k) / n of the way towards the 2nd vertex and k / n towards the 3rd
+        const auto direction {
+            [&face, n](int r, int k){ return icosphere_direction(face, { n - r, r - k, k }); }
         };
 
-        for(int st{}; st < stacks / 2; ++st){
+        for(int r{}; r < n; ++r)
+            for(int k{}; k <= r; ++k){
 
-            const angle_t curr_yOp { 90.0 - yOp_delta * static_cast<angle_t>(st + 1) };
+                sphere_triangle(
+                    mesh, radius, direction(r, k), direction(r + 1, k), direction(r + 1, k + 1)
+                );
 
-            const PolarPoint3d next_bp1 { radius_d, bp1.zOx, curr_yOp };
-            const PolarPoint3d next_bp2 { radius_d, bp2.zOx, curr_yOp };
+                if(k < r)
+                    sphere_triangle(
+                        mesh, radius, direction(r, k), direction(r + 1, k + 1), direction(r, k + 1)
+                    );
+            }
+    }
+}
 
-            vertexes_file << bp1 << bp2 << next_bp1;
-            vertexes_file << next_bp1 << bp2 << next_bp2;
+/**
+ * Subdivide each edge of an icosahedron into subdivisions segments and project
+ * the resulting points onto the sphere, yielding 20 * subdivisions^2 triangles of
+ * nearly the same size, unlike those of the UV sphere which bunch up at the poles
+ */
+static ErrorCode icosphere_writer(const string &filename, int radius, int subdivisions,
+                                  const Options &options){
+
+    return generate_mesh(
+        filename,
+        ICOSAHEDRON_FACES,
+        options,
+        [=](Mesh &m, size_t begin, size_t end){
+            icosphere_faces(m, radius, subdivisions, begin, end);
+        }
+    );
+}
 
-            const PolarPoint3d neg_bp1 { radius_d, bp1.zOx, 180.0 - bp1.yOp };
-            const PolarPoint3d neg_bp2 { radius_d, bp2.zOx, 180.0 - bp2.yOp };
-            const PolarPoint3d neg_next_bp1 { radius_d, next_bp1.zOx, 180.0 - next_bp1.yOp };
-            const PolarPoint3d neg_next_bp2 { radius_d, next_bp2.zOx, 180.0 - next_bp2.yOp };
 
-            vertexes_file << neg_next_bp1 << neg_next_bp2 << neg_bp1;
-            vertexes_file << neg_bp1 << neg_next_bp2 << neg_bp2;
 
+static constexpr size_t CUBE_FACES { 6 };
 
-            normals_file << bp1.normalize() << bp2.normalize() << next_bp1.normalize();
-            normals_file << next_bp1.normalize() << bp2.normalize() << next_bp2.normalize();
+/**
+ * Generate the rows in [first_row, last_row) of the cube sphere, appending them to mesh
+ * Each of the 6 faces is made up of divisions rows
+ *
+ * Grid coordinates are spaced by equal angles (tan_table) rather than evenly,
+ * which evens out the size of the projected quads
+ * As both ends of tan_table are exactly -1 and 1, the faces meeting at an edge
+ * compute bitwise equal points on it
+ */
+static void cubesphere_rows(Mesh &mesh, int radius, int divisions, const vector<double> &tan_table,
+                            int first_row, int last_row){
 
-            normals_file << neg_next_bp1.normalize() << neg_next_bp2.normalize()
-                         << neg_bp1.normalize();
-            normals_file << neg_bp1.normalize() << neg_next_bp2.normalize()
-                         << neg_bp2.normalize();
+    reserve_vertexes(mesh, 6 * static_cast<size_t>(divisions * (last_row - first_row)));
 
+    for(int row { first_row }; row < last_row; ++row){
 
-            const CartPoint2d t1 {
-                s_step * static_cast<double>(sl),
-                0.5 + t_step * static_cast<double>(st)
-            };
-            const CartPoint2d t2 {
-                s_step * static_cast<double>(sl + 1),
-                0.5 + t_step * static_cast<double>(st)
-            };
-            const CartPoint2d t3 {
-                s_step * static_cast<double>(sl),
-                0.5 + t_step * static_cast<double>(st + 1)
-            };
-            const CartPoint2d t4 {
-                s_step * static_cast<double>(sl + 1),
-                0.5 + t_step * static_cast<double>(st + 1)
-            };
+        //faces are given by the axis they are perpendicular to and its sign
+        const int face { row / divisions };
+        const size_t axis { static_cast<size_t>(face / 2) };
+        const double sign { face % 2 == 0 ? 1.0 : -1.0 };
 
-            text_file << t1 << t2 << t3;
-            text_file << t3 << t2 << t4;
+        const size_t u_axis { (axis + 1) % 3 };
+        const size_t v_axis { (axis + 2) % 3 };
 
-            const CartPoint2d neg_t1 { t1.x, 1.0 - t1.y };
-            const CartPoint2d neg_t2 { t2.x, 1.0 - t2.y };
-            const CartPoint2d neg_t3 { t3.x, 1.0 - t3.y };
-            const CartPoint2d neg_t4 { t4.x, 1.0 - t4.y };
+        const size_t i { static_cast<size_t>(row % divisions) };
+
+        const auto direction {
+            [&](size_t u, size_t v){
+                array<double, 3> c {};
+                c[axis] = sign;
+                c[u_axis] = tan_table[u];
+                c[v_axis] = tan_table[v];
+                return CartPoint3d { c[0], c[1], c[2] }.normalize();
+            }
+        };
 
-            text_file << neg_t3 << neg_t4 << neg_t1;
-            text_file << neg_t1 << neg_t4 << neg_t2;
+        for(size_t j{}; j < static_cast<size_t>(divisions); ++j){
 
+            const CartPoint3d d1 { direction(i, j) };
+            const CartPoint3d d2 { direction(i + 1, j) };
+            const CartPoint3d d3 { direction(i, j + 1) };
+            const CartPoint3d d4 { direction(i + 1, j + 1) };
 
-            bp1 = next_bp1;
-            bp2 = next_bp2;
+            sphere_triangle(mesh, radius, d1, d2, d4);
+            sphere_triangle(mesh, radius, d1, d4, d3);
         }
     }
-
-    return ErrorCode::success;
 }
 
-static ErrorCode cone_writer(const string &filename, int radius, int height, int slices, int stacks){
+//project a cube, each face split into divisions x divisions quads, onto the sphere
+static ErrorCode cubesphere_writer(const string &filename, int radius, int divisions,
+                                   const Options &options){
 
-    std::ofstream vertexes_file{};
-    vertexes_file.open(filename, std::ios::out | std::ios::trunc);
+    const size_t d { static_cast<size_t>(divisions) };
+    vector<double> tan_table(d + 1);
 
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(filename), std::ios::out | std::ios::trunc);
+    for(size_t k{}; k <= d; ++k)
+        tan_table[k] = std::tan(
+            static_cast<double>(PI) / 4.0 * (2.0 * static_cast<double>(k) / static_cast<double>(d) - 1.0)
+        );
 
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(filename), std::ios::out | std::ios::trunc);
+    //exact ends and symmetry, for the faces to agree on their edges
+    tan_table.front() = -1.0;
+    tan_table.back() = 1.0;
 
-    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
-        return ErrorCode::io_error;
+    for(size_t k{}; 2 * k < d; ++k)
+        tan_table[d - k] = -tan_table[k];
 
-    const angle_t zOx_delta { 360.0 / static_cast<angle_t>(slices) };
+    return generate_mesh(
+        filename,
+        CUBE_FACES * static_cast<size_t>(divisions),
+        options,
+        [&](Mesh &m, size_t begin, size_t end){
+            cubesphere_rows(m, radius, divisions, tan_table, static_cast<int>(begin), static_cast<int>(end));
+        }
+    );
+}
+
+//generate the slices in [first_slice, last_slice) of the cone, appending them to mesh
+static void cone_slices(Mesh &mesh, int radius, int height, int slices, int stacks,
+                        const TrigTable &zOx_table, int first_slice, int last_slice){
+
+    reserve_vertexes(mesh, 6 * static_cast<size_t>(stacks * (last_slice - first_slice)));
+
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
+
+    const double radius_d { static_cast<double>(radius) };
     const double height_delta { static_cast<double>(height) / static_cast<double>(stacks) };
 
     const CartPoint3d origin{};
@@ -620,48 +755,32 @@ static ErrorCode cone_writer(const string &filename, int radius, int height, int
     const CartPoint2d text_origin {};
 
     const double normal_yOp {
-        radian_to_degree(
-            std::atan(
-                static_cast<double>(height) / static_cast<double>(radius)
-            )
+        std::atan(
+            static_cast<double>(height) / static_cast<double>(radius)
         )
     };
+    const double normal_sin_yOp { std::sin(normal_yOp) };
+    const double normal_cos_yOp { std::cos(normal_yOp) };
 
     const double t_step { 1.0 / static_cast<double>(stacks) };
     const double s_step { 1.0 / static_cast<double>(slices) };
 
 
-    for(int sl{}; sl < slices; ++sl){
-
-        PolarPoint3d bp1 {
-            static_cast<double>(radius),
-            static_cast<angle_t>(sl) * zOx_delta,
-            90.0
-        };
+    for(size_t sl { static_cast<size_t>(first_slice) }; sl < static_cast<size_t>(last_slice); ++sl){
 
-        PolarPoint3d bp2 {
-            static_cast<double>(radius),
-            static_cast<angle_t>(sl + 1) * zOx_delta,
-            90.0
-        };
+        CartPoint3d bp1 { radius_d * zOx_table.sin(sl), 0.0, radius_d * zOx_table.cos(sl) };
+        CartPoint3d bp2 { radius_d * zOx_table.sin(sl + 1), 0.0, radius_d * zOx_table.cos(sl + 1) };
 
-        vertexes_file << bp1 << origin << bp2; //base
+        vertexes << bp1 << origin << bp2; //base
 
 
-        normals_file << base_normal << base_normal << base_normal;
+        normals << base_normal << base_normal << base_normal;
 
 
-        const PolarPoint2d bt1 {
-            static_cast<double>(radius),
-            static_cast<angle_t>(sl) * zOx_delta
-        };
-
-        const PolarPoint2d bt2 {
-            static_cast<double>(radius),
-            static_cast<angle_t>(sl + 1) * zOx_delta
-        };
+        const CartPoint2d bt1 { radius_d * zOx_table.cos(sl), radius_d * zOx_table.sin(sl) };
+        const CartPoint2d bt2 { radius_d * zOx_table.cos(sl + 1), radius_d * zOx_table.sin(sl + 1) };
 
-        text_file << bt1 << text_origin << bt2;
+        text_coords << bt1 << text_origin << bt2;
 
         /**
          *    /| stack 4
@@ -678,10 +797,16 @@ static ErrorCode cone_writer(const string &filename, int radius, int height, int
          *      where:
          *          r  == cone radius
          *          h  == height_delta (height / stacks)
-         * since we start in the yOz plane, x is 0
-         * that means z = stack_radius
+         * the point is then rotated by the slice's zOx
          */
 
+        const CartPoint3d normal1 {
+            from_angles(1.0, zOx_table.sin(sl), zOx_table.cos(sl), normal_sin_yOp, normal_cos_yOp)
+        };
+        const CartPoint3d normal2 {
+            from_angles(1.0, zOx_table.sin(sl + 1), zOx_table.cos(sl + 1), normal_sin_yOp, normal_cos_yOp)
+        };
+
         for(int st{}; st < stacks; ++st){
 
             const double stack_radius {
@@ -693,23 +818,18 @@ static ErrorCode cone_writer(const string &filename, int radius, int height, int
                 static_cast<double>(st + 1) * height_delta
             };
 
-            PolarPoint3d next_bp1 {
-                cart_to_polar( { 0.0, stack_height, stack_radius } )
+            const CartPoint3d next_bp1 {
+                stack_radius * zOx_table.sin(sl), stack_height, stack_radius * zOx_table.cos(sl)
             };
-            next_bp1.zOx = bp1.zOx;
 
-            PolarPoint3d next_bp2 {
-                cart_to_polar( { 0.0, stack_height, stack_radius } )
+            const CartPoint3d next_bp2 {
+                stack_radius * zOx_table.sin(sl + 1), stack_height, stack_radius * zOx_table.cos(sl + 1)
             };
-            next_bp2.zOx = bp2.zOx;
 
-            vertexes_file << bp1 << bp2 << next_bp1;
+            vertexes << bp1 << bp2 << next_bp1;
 
 
-            const PolarPoint3d normal1 { 1.0, bp1.zOx, normal_yOp };
-            const PolarPoint3d normal2 { 1.0, bp2.zOx, normal_yOp };
-
-            normals_file << normal1 << normal2 << normal1;
+            normals << normal1 << normal2 << normal1;
 
 
             const CartPoint2d t1 {
@@ -725,15 +845,15 @@ static ErrorCode cone_writer(const string &filename, int radius, int height, int
                 t_step * static_cast<double>(st + 1)
             };
 
-            text_file << t1 << t2 << t3;
+            text_coords << t1 << t2 << t3;
 
 
             if(st < stacks - 1){
 
-                vertexes_file << next_bp1 << bp2 << next_bp2;
+                vertexes << next_bp1 << bp2 << next_bp2;
 
 
-                normals_file << normal1 << normal2 << normal2;
+                normals << normal1 << normal2 << normal2;
 
 
                 const CartPoint2d t4 {
@@ -741,30 +861,53 @@ static ErrorCode cone_writer(const string &filename, int radius, int height, int
                     t_step * static_cast<double>(st + 1)
                 };
 
-                text_file << t3 << t2 << t4;
+                text_coords << t3 << t2 << t4;
             }
 
             bp1 = next_bp1;
             bp2 = next_bp2;
         }
     }
+}
 
-    return ErrorCode::success;
+static ErrorCode cone_writer(const string &filename, int radius, int height, int slices, int stacks,
+                             const Options &options){
+
+    const angle_t zOx_delta { 360.0 / static_cast<angle_t>(slices) };
+    const TrigTable zOx_table { static_cast<size_t>(slices), 0.0, zOx_delta };
+
+    return generate_mesh(
+        filename,
+        static_cast<size_t>(slices),
+        options,
+        [&](Mesh &m, size_t begin, size_t end){
+            cone_slices(m, radius, height, slices, stacks, zOx_table,
+                        static_cast<int>(begin), static_cast<int>(end));
+        }
+    );
 }
 
-static ErrorCode box_writer(const string &filename, int units, int grid_size){
+//the rows of face (out of grid_size rows per face) that fall in [first_row, last_row)
+static tuple<int, int> face_rows(int face, int grid_size, int first_row, int last_row){
 
-    std::ofstream vertexes_file{};
-    vertexes_file.open(filename, std::ios::out | std::ios::trunc);
+    const int begin { std::clamp(first_row - face * grid_size, 0, grid_size) };
+    const int end { std::clamp(last_row - face * grid_size, 0, grid_size) };
 
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(filename), std::ios::out | std::ios::trunc);
+    return { begin, end };
+}
 
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(filename), std::ios::out | std::ios::trunc);
+/**
+ * Generate the rows in [first_row, last_row) of the box, appending them to mesh
+ * The box is made up of 3 * grid_size rows: the y faces' first, then the x faces'
+ * and lastly the z faces'
+ */
+static void box_rows(Mesh &mesh, int units, int grid_size, int first_row, int last_row){
 
-    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
-        return ErrorCode::io_error;
+    reserve_vertexes(mesh, 12 * static_cast<size_t>(grid_size * (last_row - first_row)));
+
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
 
     const double abs_max_coord { static_cast<double>(units) / 2.0 };
     const double step { static_cast<double>(units) / static_cast<double>(grid_size) };
@@ -775,8 +918,6 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
     double x {}, y {}, z {};
 
 
-    x = abs_max_coord;
-
     CartPoint3d normal1 { 0.0,  1.0, 0.0 };
     CartPoint3d normal2 { 0.0, -1.0, 0.0 };
 
@@ -784,9 +925,12 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
     double s {}, t {};  //coordinates in texture space
 
 
-    s = 1.0;
+    auto [first, last] { face_rows(0, grid_size, first_row, last_row) };
+
+    x = replay_steps(abs_max_coord, step, first);
+    s = replay_steps(1.0, text_step, first);
 
-    for(int i{}; i < grid_size; ++i, x -= step, s -= text_step){
+    for(int i { first }; i < last; ++i, x -= step, s -= text_step){
 
         z = abs_max_coord;
         t = 1.0;
@@ -800,20 +944,20 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             p3.x = x - step; p3.z = z;
             p4.x = x - step; p4.z = z - step;
 
-            vertexes_file << p1 << p2 << p4;
-            vertexes_file << p4 << p3 << p1;
+            vertexes << p1 << p2 << p4;
+            vertexes << p4 << p3 << p1;
 
             p1.y = p2.y = p3.y = p4.y = -abs_max_coord;
 
-            vertexes_file << p1 << p3 << p2;
-            vertexes_file << p2 << p3 << p4;
+            vertexes << p1 << p3 << p2;
+            vertexes << p2 << p3 << p4;
 
 
-            normals_file << normal1 << normal1 << normal1;
-            normals_file << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
 
-            normals_file << normal2 << normal2 << normal2;
-            normals_file << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
 
 
             t1.x = s; t1.y = t;
@@ -821,22 +965,23 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             t3.x = s - text_step; t3.y = t;
             t4.x = s - text_step; t4.y = t - text_step;
 
-            text_file << t1 << t2 << t4;
-            text_file << t4 << t3 << t1;
+            text_coords << t1 << t2 << t4;
+            text_coords << t4 << t3 << t1;
 
-            text_file << t1 << t3 << t2;
-            text_file << t2 << t3 << t4;
+            text_coords << t1 << t3 << t2;
+            text_coords << t2 << t3 << t4;
         }
     }
 
-    y = abs_max_coord;
-
     normal1 = { 1.0,  0.0, 0.0 };
     normal2 = { -1.0, 0.0, 0.0 };
 
-    s = 1.0;
+    std::tie(first, last) = face_rows(1, grid_size, first_row, last_row);
+
+    y = replay_steps(abs_max_coord, step, first);
+    s = replay_steps(1.0, text_step, first);
 
-    for(int i{}; i < grid_size; ++i, y -= step, s -= text_step){
+    for(int i { first }; i < last; ++i, y -= step, s -= text_step){
 
         z = abs_max_coord;
         t = 1.0;
@@ -850,20 +995,20 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             p3.y = y - step; p3.z = z;
             p4.y = y - step; p4.z = z - step;
 
-            vertexes_file << p1 << p4 << p2;
-            vertexes_file << p1 << p3 << p4;
+            vertexes << p1 << p4 << p2;
+            vertexes << p1 << p3 << p4;
 
             p1.x = p2.x = p3.x = p4.x = -abs_max_coord;
 
-            vertexes_file << p1 << p2 << p3;
-            vertexes_file << p2 << p4 << p3;
+            vertexes << p1 << p2 << p3;
+            vertexes << p2 << p4 << p3;
 
 
-            normals_file << normal1 << normal1 << normal1;
-            normals_file << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
 
-            normals_file << normal2 << normal2 << normal2;
-            normals_file << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
 
 
             t1.x = s; t1.y = t;   // t -> y; s -> z
@@ -871,22 +1016,23 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             t3.x = s; t3.y = t - text_step;
             t4.x = s - text_step; t4.y = t - text_step;
 
-            text_file << t1 << t4 << t2;
-            text_file << t1 << t3 << t4;
+            text_coords << t1 << t4 << t2;
+            text_coords << t1 << t3 << t4;
 
-            text_file << t1 << t2 << t3;
-            text_file << t2 << t4 << t3;
+            text_coords << t1 << t2 << t3;
+            text_coords << t2 << t4 << t3;
         }
     }
 
-    y = abs_max_coord;
-
     normal1 = { 0.0, 0.0, 1.0  };
     normal2 = { 0.0, 0.0, -1.0 };
 
-    s = 1.0;
+    std::tie(first, last) = face_rows(2, grid_size, first_row, last_row);
+
+    y = replay_steps(abs_max_coord, step, first);
+    s = replay_steps(1.0, text_step, first);
 
-    for(int i{}; i < grid_size; i++, y -= step, s -= text_step){
+    for(int i { first }; i < last; i++, y -= step, s -= text_step){
 
         x = abs_max_coord;
         t = 1.0;
@@ -900,20 +1046,20 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             p3.y = y - step; p3.x = x;
             p4.y = y - step; p4.x = x - step;
 
-            vertexes_file << p1 << p2 << p4;
-            vertexes_file << p1 << p4 << p3;
+            vertexes << p1 << p2 << p4;
+            vertexes << p1 << p4 << p3;
 
             p1.z = p2.z = p3.z = p4.z = -abs_max_coord;
 
-            vertexes_file << p1 << p3 << p2;
-            vertexes_file << p2 << p3 << p4;
+            vertexes << p1 << p3 << p2;
+            vertexes << p2 << p3 << p4;
 
 
-            normals_file << normal1 << normal1 << normal1;
-            normals_file << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
+            normals << normal1 << normal1 << normal1;
 
-            normals_file << normal2 << normal2 << normal2;
-            normals_file << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
+            normals << normal2 << normal2 << normal2;
 
 
             t1.x = s; t1.y = t; //t -> y; s -> x
@@ -921,30 +1067,35 @@ static ErrorCode box_writer(const string &filename, int units, int grid_size){
             t3.x = s; t3.y = t - text_step;
             t4.x = s - text_step; t4.y = t - text_step;
 
-            text_file << t1 << t2 << t4;
-            text_file << t1 << t4 << t3;
+            text_coords << t1 << t2 << t4;
+            text_coords << t1 << t4 << t3;
 
-            text_file << t1 << t3 << t2;
-            text_file << t2 << t3 << t4;
+            text_coords << t1 << t3 << t2;
+            text_coords << t2 << t3 << t4;
         }
     }
-
-    return ErrorCode::success;
 }
 
-static ErrorCode plane_writer(const string &filename, int length, int divs){
+static ErrorCode box_writer(const string &filename, int units, int grid_size, const Options &options){
 
-    std::ofstream vertexes_file{};
-    vertexes_file.open(filename, std::ios::out | std::ios::trunc);
+    return generate_mesh(
+        filename,
+        3 * static_cast<size_t>(grid_size),
+        options,
+        [=](Mesh &m, size_t begin, size_t end){
+            box_rows(m, units, grid_size, static_cast<int>(begin), static_cast<int>(end));
+        }
+    );
+}
 
-    std::ofstream normals_file{};
-    normals_file.open(to_norm_extension(filename), std::ios::out | std::ios::trunc);
+//generate the rows in [first_row, last_row) of the plane, appending them to mesh
+static void plane_rows(Mesh &mesh, int length, int divs, int first_row, int last_row){
 
-    std::ofstream text_file{};
-    text_file.open(to_text_extension(filename), std::ios::out | std::ios::trunc);
+    reserve_vertexes(mesh, 6 * static_cast<size_t>(divs * (last_row - first_row)));
 
-    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open())
-        return ErrorCode::io_error;
+    vector<CartPoint3d>& vertexes { mesh.vertexes };
+    vector<CartPoint3d>& normals { mesh.normals };
+    vector<CartPoint2d>& text_coords { mesh.text_coords };
 
     const double abs_max_coord { static_cast<double>(length) / 2.0 };
     const double step { static_cast<double>(length) / static_cast<double>(divs) };
@@ -954,10 +1105,10 @@ static ErrorCode plane_writer(const string &filename, int length, int divs){
     const CartPoint3d normal { 0.0, 1.0, 0.0 };           //constant for all points of the plane
     CartPoint2d t1 {}, t2 {}, t3 {}, t4 {};
 
-    double x { abs_max_coord };
-    double s { 1.0 };
+    double x { replay_steps(abs_max_coord, step, first_row) };
+    double s { replay_steps(1.0, text_step, first_row) };
 
-    for(int i{}; i < divs; ++i, x -= step, s -= text_step){
+    for(int i { first_row }; i < last_row; ++i, x -= step, s -= text_step){
 
         double z { abs_max_coord };
         double t { 1.0 };
@@ -969,12 +1120,12 @@ static ErrorCode plane_writer(const string &filename, int length, int divs){
             p3.x = x - step; p3.z = z;
             p4.x = x - step; p4.z = z - step;
 
-            vertexes_file << p1 << p4 << p3;
-            vertexes_file << p1 << p2 << p4;
+            vertexes << p1 << p4 << p3;
+            vertexes << p1 << p2 << p4;
 
 
-            normals_file << normal << normal << normal;
-            normals_file << normal << normal << normal;
+            normals << normal << normal << normal;
+            normals << normal << normal << normal;
 
 
             t1.x = p1.x; t1.y = p1.z;
@@ -982,19 +1133,30 @@ static ErrorCode plane_writer(const string &filename, int length, int divs){
             t3.x = p3.x; t3.y = p3.z;
             t4.x = p4.x; t4.y = p4.z;
 
-            text_file << t1 << t4 << t3;
-            text_file << t1 << t2 << t4;
+            text_coords << t1 << t4 << t3;
+            text_coords << t1 << t2 << t4;
         }
     }
+}
+
+static ErrorCode plane_writer(const string &filename, int length, int divs, const Options &options){
 
-    return ErrorCode::success;
+    return generate_mesh(
+        filename,
+        static_cast<size_t>(divs),
+        options,
+        [=](Mesh &m, size_t begin, size_t end){
+            plane_rows(m, length, divs, static_cast<int>(begin), static_cast<int>(end));
+        }
+    );
 }
 
 
 
 //parse the arguments needed for each primitive and call the respective function
-ErrorCode primitive_writer(int size, const string args[]){
+static ErrorCode generate_primitive(const vector<string> &args, const Options &options){
 
+    const int size { static_cast<int>(args.size()) };
     unsigned args_index { 1 };
 
     if(size == 1)
@@ -1022,7 +1184,7 @@ ErrorCode primitive_writer(int size, const string args[]){
         if(length < 1 || divs < 1)
             return ErrorCode::invalid_argument;
 
-        return plane_writer(filename, length, divs);
+        return plane_writer(filename, length, divs, options);
     }
 
     case Primitive::box: {
@@ -1041,7 +1203,7 @@ ErrorCode primitive_writer(int size, const string args[]){
         if(units < 1 || grid_size < 1)
             return ErrorCode::invalid_argument;
 
-        return box_writer(filename, units, grid_size);
+        return box_writer(filename, units, grid_size, options);
     }
 
     case Primitive::cone: {
@@ -1062,7 +1224,7 @@ ErrorCode primitive_writer(int size, const string args[]){
         if(radius < 1 || height < 1 || slices < 3 || stacks < 1)
             return ErrorCode::invalid_argument;
 
-        return cone_writer(filename, radius, height, slices, stacks);
+        return cone_writer(filename, radius, height, slices, stacks, options);
     }
 
     case Primitive::sphere: {
@@ -1082,7 +1244,45 @@ ErrorCode primitive_writer(int size, const string args[]){
         if(radius < 1 || slices < 3 || stacks < 2 || stacks % 2 != 0)
             return ErrorCode::invalid_argument;
 
-        return sphere_writer(filename, radius, slices, stacks);
+        return sphere_writer(filename, radius, slices, stacks, options);
+    }
+
+    case Primitive::icosphere: {
+
+        if(size < ICOSPHERE_ARGS)
+            return ErrorCode::not_enough_args;
+
+        const int radius { string_to_uint(args[args_index++]) };
+        const int subdivisions { string_to_uint(args[args_index++]) };
+        const string filename { args[args_index] };
+
+
+        if(!has_3d_ext(filename))
+            return ErrorCode::invalid_file_extension;
+
+        if(radius < 1 || subdivisions < 1)
+            return ErrorCode::invalid_argument;
+
+        return icosphere_writer(filename, radius, subdivisions, options);
+    }
+
+    case Primitive::cubesphere: {
+
+        if(size < CUBESPHERE_ARGS)
+            return ErrorCode::not_enough_args;
+
+        const int radius { string_to_uint(args[args_index++]) };
+        const int divisions { string_to_uint(args[args_index++]) };
+        const string filename { args[args_index] };
+
+
+        if(!has_3d_ext(filename))
+            return ErrorCode::invalid_file_extension;
+
+        if(radius < 1 || divisions < 1)
+            return ErrorCode::invalid_argument;
+
+        return cubesphere_writer(filename, radius, divisions, options);
     }
 
     case Primitive::torus: {
@@ -1109,7 +1309,7 @@ ErrorCode primitive_writer(int size, const string args[]){
         )
             return ErrorCode::invalid_argument;
 
-        return torus_writer(filename, out_radius, in_radius, slices, stacks);
+        return torus_writer(filename, out_radius, in_radius, slices, stacks, options);
     }
 
     case Primitive::bezier: {
@@ -1128,10 +1328,106 @@ ErrorCode primitive_writer(int size, const string args[]){
         if(tesselation_level < 1)
             return ErrorCode::invalid_argument;
 
-        return bezier_writer(out_filename, in_filename, static_cast<unsigned>(tesselation_level));
+        return bezier_writer(
+            out_filename,
+            in_filename,
+            static_cast<unsigned>(tesselation_level),
+            options
+        );
+    }
+
+    case Primitive::optimize: {
+
+        if(size < OPTIMIZE_ARGS)
+            return ErrorCode::not_enough_args;
+
+        const string in_filename { args[args_index++] };
+        const string out_filename { args[args_index] };
+
+
+        if(!has_3d_ext(in_filename) || !has_3d_ext(out_filename))
+            return ErrorCode::invalid_file_extension;
+
+        return optimize_writer(in_filename, out_filename, options);
+    }
+
+    case Primitive::simplify: {
+
+        if(size < SIMPLIFY_ARGS)
+            return ErrorCode::not_enough_args;
+
+        const string in_filename { args[args_index++] };
+        const int triangles { string_to_uint(args[args_index++]) };
+        const string out_filename { args[args_index] };
+
+
+        if(!has_3d_ext(in_filename) || !has_3d_ext(out_filename))
+            return ErrorCode::invalid_file_extension;
+
+        if(triangles < 0)
+            return ErrorCode::invalid_argument;
+
+        return simplify_writer(in_filename, static_cast<size_t>(triangles), out_filename, options);
     }
 
     default:
         return ErrorCode::invalid_argument;
     }
+}
+
+//parse the command line, either running a batch or generating a single primitive
+ErrorCode primitive_writer(int argc, const string argv[]){
+
+    auto const& [code, options, args] { parse_options(argc, argv) };
+    if(code != ErrorCode::success)
+        return code;
+
+    if(args.size() > 1 && args[1] == "batch"){
+
+        if(args.size() < BATCH_ARGS)
+            return ErrorCode::not_enough_args;
+
+        return batch_writer(args[0], args[2], options);
+    }
+
+    return primitive_writer(args, options);
+}
+
+/**
+ * Generate the primitive described by args, the positional arguments
+ * starting with the program name, unless its output is up to date
+ */
+ErrorCode primitive_writer(const vector<string> &args, const Options &in_options){
+
+    Options options { in_options };
+
+    //optimized meshes are only ever written indexed
+    if(args.size() > 1 && args[1] == "optimize")
+        options.binary = options.indexed = true;
+
+    //simplify writes its own levels of detail, from the input mesh rather than by regenerating it
+    const bool simplify { args.size() > 1 && args[1] == "simplify" };
+
+    if(options.lods > 1 && !simplify)
+        return lod_writer(args, options);
+
+    //invalid arguments are left for generate_primitive to report
+    if(args.size() < 2 || !has_3d_ext(args.back()))
+        return generate_primitive(args, options);
+
+    const string &out_fn { args.back() };
+    const uint64_t hash { generation_hash(args, options) };
+
+    if(!options.force && is_up_to_date(out_fn, options, hash)){
+        std::cout << out_fn << " is up to date\n";
+        return ErrorCode::success;
+    }
+
+    forget_hash(out_fn);
+
+    const ErrorCode code { generate_primitive(args, options) };
+    if(code != ErrorCode::success)
+        return code;
+
+    return record_hash(out_fn, hash);
 }
\ No newline at end of file
@@ -0,0 +1,704 @@
+#include "simplify.hpp"
+#include "lod.hpp"
+#include "mesh_writer.hpp"
+#include "text_reader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::array;
+using std::pair;
+
+
+
+//positions closer than this, relative to the size of the mesh, are welded together
+static constexpr double POSITION_TOLERANCE { 1e-9 };
+
+//how much borders and seams weigh against the triangles along them, per squared length
+static constexpr double EDGE_WEIGHT { 10.0 };
+
+//a triangle whose normal turns by more than about 75 degrees is taken to fold over
+static constexpr double FLIP_COSINE { 0.25 };
+
+/**
+ * Each pass only takes collapses costing up to this many times as much as
+ * the one that would reach the target, had every cheaper one been taken,
+ * so that a pass doesn't resort to costly collapses while cheap ones are only held back
+ * by having a neighbour collapsed in the same pass
+ */
+static constexpr double PASS_ERROR_FACTOR { 1.5 };
+
+
+
+static double dot(const CartPoint3d &a, const CartPoint3d &b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static double length(const CartPoint3d &a){
+    return std::sqrt(dot(a, a));
+}
+
+
+
+/** Quadric **/
+
+Quadric::Quadric() :
+    a(), b(), c(0.0), area(0.0) {}
+
+//the plane of the points p for which dot(normal, p) + distance == 0, normal being of unit length
+Quadric::Quadric(const CartPoint3d &normal, double distance, double weight) :
+    a({
+        weight * normal.x * normal.x, weight * normal.y * normal.y, weight * normal.z * normal.z,
+        weight * normal.x * normal.y, weight * normal.x * normal.z, weight * normal.y * normal.z
+    }),
+    b({ weight * normal.x * distance, weight * normal.y * distance, weight * normal.z * distance }),
+    c(weight * distance * distance),
+    area(0.0)
+{}
+
+Quadric& Quadric::operator+=(const Quadric &q){
+
+    for(size_t i{}; i < this->a.size(); ++i)
+        this->a[i] += q.a[i];
+
+    for(size_t i{}; i < this->b.size(); ++i)
+        this->b[i] += q.b[i];
+
+    this->c += q.c;
+    this->area += q.area;
+
+    return *this;
+}
+
+//the average squared distance of p to the planes
+double Quadric::error(const CartPoint3d &p) const {
+
+    const array<double, 6> &a { this->a };
+    const array<double, 3> &b { this->b };
+
+    const double sum {
+        a[0] * p.x * p.x + a[1] * p.y * p.y + a[2] * p.z * p.z +
+        2.0 * (a[3] * p.x * p.y + a[4] * p.x * p.z + a[5] * p.y * p.z) +
+        2.0 * (b[0] * p.x + b[1] * p.y + b[2] * p.z) +
+        this->c
+    };
+
+    //rounding may take it slightly below 0
+    return std::max(sum, 0.0) / (this->area > 0.0 ? this->area : 1.0);
+}
+
+
+
+/** Simplifier **/
+
+//the triangles using each position p are triangles[offsets[p]] up to triangles[offsets[p + 1]]
+struct Adjacency {
+    vector<uint32_t> offsets;
+    vector<uint32_t> triangles;
+};
+
+static Adjacency build_adjacency(const vector<uint32_t> &indexes, const vector<uint32_t> &position){
+
+    const size_t vertex_count { position.size() };
+    Adjacency adjacency { vector<uint32_t>(vertex_count + 1, 0), vector<uint32_t>(indexes.size()) };
+
+    for(uint32_t i : indexes)
+        ++adjacency.offsets[position[i] + 1];
+
+    for(size_t p{}; p < vertex_count; ++p)
+        adjacency.offsets[p + 1] += adjacency.offsets[p];
+
+    vector<uint32_t> filled { adjacency.offsets.begin(), adjacency.offsets.end() - 1 };
+
+    for(size_t i{}; i < indexes.size(); ++i)
+        adjacency.triangles[filled[position[indexes[i]]]++] = static_cast<uint32_t>(i / 3);
+
+    return adjacency;
+}
+
+struct PositionHash {
+    size_t operator()(const array<int64_t, 3> &p) const {
+
+        //FNV-1a over the bytes of each coordinate
+        uint64_t hash { 14695981039346656037ULL };
+
+        for(int64_t c : p){
+
+            uint64_t bits { static_cast<uint64_t>(c) };
+
+            for(unsigned i{}; i < sizeof(bits); ++i, bits >>= 8){
+                hash ^= bits & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        return static_cast<size_t>(hash);
+    }
+};
+
+//the uses of an edge, between two positions
+struct EdgeUse {
+    uint32_t count;
+    uint32_t from;          //vertexes of the first triangle found using it, in its winding
+    uint32_t to;
+    bool seam;              //the other triangle has other vertexes at either end
+    bool non_manifold;      //more than two triangles, or two wound the same way
+};
+
+static uint64_t edge_key(uint32_t a, uint32_t b){
+    return a < b ? (uint64_t{ a } << 32) | b : (uint64_t{ b } << 32) | a;
+}
+
+static size_t next_corner(size_t i){
+    return i % 3 == 2 ? i - 2 : i + 1;
+}
+
+static bool is_degenerate(const array<uint32_t, 3> &p){
+    return p[0] == p[1] || p[1] == p[2] || p[0] == p[2];
+}
+
+Simplifier::Simplifier(Mesh &&welded) :
+    mesh(std::move(welded)), indexes(), position(), next_vertex(), kinds(), quadrics(), surface_normals(),
+    max_collapse_error(0.0)
+{
+    const size_t vertex_count { this->mesh.vertexes.size() };
+
+    this->position.resize(vertex_count);
+    this->next_vertex.resize(vertex_count);
+
+    /**
+     * Positions a rounding error apart are taken as one, e.g. where a sphere closes at 2 pi,
+     * or the mesh would be split along them, and each side simplified on its own
+     */
+    const Bounds bounds { points_bounds(this->mesh.vertexes) };
+    const double extent {
+        std::max({ bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y, bounds.max.z - bounds.min.z })
+    };
+    const double cell { extent > 0.0 ? POSITION_TOLERANCE * extent : 1.0 };
+
+    //the first vertex at each position stands for it
+    std::unordered_map<array<int64_t, 3>, uint32_t, PositionHash> first_vertex {};
+    first_vertex.reserve(vertex_count);
+
+    for(uint32_t v{}; v < vertex_count; ++v){
+
+        const CartPoint3d &p { this->mesh.vertexes[v] };
+        const array<int64_t, 3> key { std::llround(p.x / cell), std::llround(p.y / cell), std::llround(p.z / cell) };
+
+        auto const& [iter, inserted] { first_vertex.try_emplace(key, v) };
+        const uint32_t first { iter->second };
+
+        this->position[v] = first;
+
+        if(inserted)
+            this->next_vertex[v] = v;
+        else{
+            this->next_vertex[v] = this->next_vertex[first];
+            this->next_vertex[first] = v;
+        }
+    }
+
+    //triangles with two corners at the same position have no area to keep
+    this->indexes.reserve(this->mesh.indexes.size());
+
+    for(size_t i{}; i + 2 < this->mesh.indexes.size(); i += 3){
+
+        const array<uint32_t, 3> p {
+            this->position[this->mesh.indexes[i]],
+            this->position[this->mesh.indexes[i + 1]],
+            this->position[this->mesh.indexes[i + 2]]
+        };
+
+        if(!is_degenerate(p))
+            this->indexes.insert(this->indexes.end(), this->mesh.indexes.begin() + static_cast<std::ptrdiff_t>(i),
+                                 this->mesh.indexes.begin() + static_cast<std::ptrdiff_t>(i + 3));
+    }
+
+    this->mesh.indexes = vector<uint32_t>{};
+    this->mesh.meshlets.clear();
+
+    this->classify();
+}
+
+//find the kind and the quadric of each position
+void Simplifier::classify(){
+
+    const size_t vertex_count { this->mesh.vertexes.size() };
+    const vector<CartPoint3d> &points { this->mesh.vertexes };
+
+    std::unordered_map<uint64_t, EdgeUse> edges {};
+    edges.reserve(this->indexes.size());
+
+    for(size_t i{}; i < this->indexes.size(); ++i){
+
+        const uint32_t from { this->indexes[i] };
+        const uint32_t to { this->indexes[next_corner(i)] };
+
+        EdgeUse &use { edges[edge_key(this->position[from], this->position[to])] };
+
+        if(use.count == 0){
+            use.from = from;
+            use.to = to;
+        }
+        //the other triangle of a manifold edge runs it the other way
+        else if(use.count > 1 || this->position[use.from] != this->position[to])
+            use.non_manifold = true;
+        else if(use.from != to || use.to != from)
+            use.seam = true;
+
+        ++use.count;
+    }
+
+    vector<uint32_t> border_edges(vertex_count, 0);
+    vector<uint32_t> seam_edges(vertex_count, 0);
+    vector<bool> non_manifold(vertex_count, false);
+
+    for(auto const& [key, use] : edges){
+
+        const uint32_t a { this->position[use.from] };
+        const uint32_t b { this->position[use.to] };
+
+        if(use.non_manifold)
+            non_manifold[a] = non_manifold[b] = true;
+
+        else if(use.count == 1){
+            ++border_edges[a];
+            ++border_edges[b];
+        }
+
+        else if(use.seam){
+            ++seam_edges[a];
+            ++seam_edges[b];
+        }
+    }
+
+    //a position is free to move along a border or a seam only where a single one runs through it
+    this->kinds.assign(vertex_count, VertexKind::locked);
+
+    for(uint32_t p{}; p < vertex_count; ++p){
+
+        if(this->position[p] != p || non_manifold[p])
+            continue;
+
+        size_t vertexes { 1 };
+        for(uint32_t v { this->next_vertex[p] }; v != p; v = this->next_vertex[v])
+            ++vertexes;
+
+        if(border_edges[p] == 0 && seam_edges[p] == 0 && vertexes == 1)
+            this->kinds[p] = VertexKind::free;
+
+        else if(border_edges[p] == 2 && seam_edges[p] == 0 && vertexes == 1)
+            this->kinds[p] = VertexKind::border;
+
+        else if(border_edges[p] == 0 && seam_edges[p] == 2 && vertexes == 2)
+            this->kinds[p] = VertexKind::seam;
+    }
+
+    this->quadrics.assign(vertex_count, Quadric{});
+    this->surface_normals.assign(vertex_count, CartPoint3d{});
+
+    for(size_t i{}; i < this->indexes.size(); i += 3){
+
+        const CartPoint3d &p0 { points[this->indexes[i]] };
+
+        CartPoint3d normal { cross_product(points[this->indexes[i + 1]] - p0, points[this->indexes[i + 2]] - p0) };
+        const double double_area { length(normal) };
+
+        if(double_area == 0.0)
+            continue;
+
+        for(size_t c{}; c < 3; ++c)
+            this->surface_normals[this->position[this->indexes[i + c]]] += normal;
+
+        normal = normal * (1.0 / double_area);
+
+        Quadric plane { normal, -dot(normal, p0), 0.5 * double_area };
+        plane.area = 0.5 * double_area;
+
+        for(size_t c{}; c < 3; ++c)
+            this->quadrics[this->position[this->indexes[i + c]]] += plane;
+
+        //borders and seams are held in place by planes through them, at right angles to the triangle
+        for(size_t c{}; c < 3; ++c){
+
+            const uint32_t from { this->indexes[i + c] };
+            const uint32_t to { this->indexes[next_corner(i + c)] };
+
+            const EdgeUse &use { edges.at(edge_key(this->position[from], this->position[to])) };
+
+            if(use.non_manifold || (use.count == 2 && !use.seam))
+                continue;
+
+            const CartPoint3d edge { points[to] - points[from] };
+            const double edge_length { length(edge) };
+
+            if(edge_length == 0.0)
+                continue;
+
+            const CartPoint3d edge_normal { cross_product(edge, normal) * (1.0 / edge_length) };
+
+            //only triangles count towards the average
+            const Quadric edge_plane {
+                edge_normal, -dot(edge_normal, points[from]), EDGE_WEIGHT * edge_length * edge_length
+            };
+
+            this->quadrics[this->position[from]] += edge_plane;
+            this->quadrics[this->position[to]] += edge_plane;
+        }
+    }
+}
+
+//collapse edges once cheapest first, without touching any position twice, and return the triangles removed
+size_t Simplifier::collapse_pass(size_t target, double error_limit){
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double error;
+    };
+
+    const size_t vertex_count { this->mesh.vertexes.size() };
+    const vector<CartPoint3d> &points { this->mesh.vertexes };
+    const size_t triangles { this->indexes.size() / 3 };
+
+    const Adjacency adjacency { build_adjacency(this->indexes, this->position) };
+
+    //constrained positions only move onto others on their border or seam, checked once collapsing
+    const auto may_move { [this](uint32_t from, uint32_t to){
+        return this->kinds[from] == VertexKind::free ||
+               (this->kinds[from] != VertexKind::locked && this->kinds[to] != VertexKind::free);
+    } };
+
+    const auto cost { [this, &points](uint32_t from, uint32_t to){
+        Quadric q { this->quadrics[from] };
+        q += this->quadrics[to];
+        return q.error(points[to]);
+    } };
+
+    //the cheaper way to collapse each edge
+    vector<Collapse> collapses {};
+    collapses.reserve(this->indexes.size());
+
+    for(size_t i{}; i < this->indexes.size(); ++i){
+
+        const uint32_t a { this->position[this->indexes[i]] };
+        const uint32_t b { this->position[this->indexes[next_corner(i)]] };
+
+        const double ab { may_move(a, b) ? cost(a, b) : std::numeric_limits<double>::infinity() };
+        const double ba { may_move(b, a) ? cost(b, a) : std::numeric_limits<double>::infinity() };
+
+        if(std::isinf(ab) && std::isinf(ba))
+            continue;
+
+        collapses.push_back(ab <= ba ? Collapse{ a, b, ab } : Collapse{ b, a, ba });
+    }
+
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse &c1, const Collapse &c2){
+        if(c1.error != c2.error)
+            return c1.error < c2.error;
+        return c1.from != c2.from ? c1.from < c2.from : c1.to < c2.to;
+    });
+
+    //both triangles along an edge list it
+    collapses.erase(
+        std::unique(collapses.begin(), collapses.end(), [](const Collapse &c1, const Collapse &c2){
+            return c1.from == c2.from && c1.to == c2.to;
+        }),
+        collapses.end()
+    );
+
+    const size_t goal { triangles - target };
+
+    //each collapse takes out about two triangles
+    const double pass_limit {
+        goal / 2 < collapses.size() ?
+            std::min(error_limit, PASS_ERROR_FACTOR * collapses[goal / 2].error) :
+            error_limit
+    };
+
+    vector<bool> touched(vertex_count, false);
+    vector<uint32_t> remap(vertex_count);
+    std::iota(remap.begin(), remap.end(), 0);
+
+    vector<pair<uint32_t, uint32_t>> moves {};
+    vector<uint32_t> moving {};
+    vector<uint32_t> from_neighbours {};
+    vector<uint32_t> to_neighbours {};
+
+    //the triangles around p, as positions as of the collapses so far
+    const auto for_each_triangle { [&](uint32_t p, const auto &visit){
+        for(uint32_t a { adjacency.offsets[p] }; a < adjacency.offsets[p + 1]; ++a){
+
+            const size_t t { adjacency.triangles[a] };
+
+            const array<uint32_t, 3> v {
+                remap[this->indexes[3 * t]], remap[this->indexes[3 * t + 1]], remap[this->indexes[3 * t + 2]]
+            };
+            const array<uint32_t, 3> tp { this->position[v[0]], this->position[v[1]], this->position[v[2]] };
+
+            if(!is_degenerate(tp) && !visit(v, tp))
+                return false;
+        }
+
+        return true;
+    } };
+
+    /**
+     * Move the corners at from onto to and return the triangles along the edge, which are taken out,
+     * unless the collapse would tear a border or a seam, fold a triangle or pinch the surface
+     */
+    const auto try_collapse { [&](uint32_t from, uint32_t to) -> size_t {
+
+        moves.clear();
+        moving.clear();
+        from_neighbours.clear();
+        to_neighbours.clear();
+
+        const bool unfolded {
+            for_each_triangle(from, [&](const array<uint32_t, 3> &v, const array<uint32_t, 3> &tp){
+
+                const size_t f { static_cast<size_t>(std::find(tp.begin(), tp.end(), from) - tp.begin()) };
+                const size_t t { static_cast<size_t>(std::find(tp.begin(), tp.end(), to) - tp.begin()) };
+
+                const uint32_t b { tp[(f + 1) % 3] };
+                const uint32_t c { tp[(f + 2) % 3] };
+
+                from_neighbours.push_back(b);
+                from_neighbours.push_back(c);
+
+                //the vertex at from takes on the one at to on the same side of the edge
+                if(t < 3){
+                    moves.emplace_back(v[f], v[t]);
+                    return true;
+                }
+
+                moving.push_back(v[f]);
+
+                const CartPoint3d before { cross_product(points[b] - points[from], points[c] - points[from]) };
+                const CartPoint3d after { cross_product(points[b] - points[to], points[c] - points[to]) };
+
+                /**
+                 * Checking against the triangle as it is only bounds each collapse,
+                 * and a triangle may turn a little at a time until it faces inwards
+                 */
+                return dot(before, after) > FLIP_COSINE * length(before) * length(after) &&
+                       dot(after, this->surface_normals[to]) > 0.0 &&
+                       dot(after, this->surface_normals[b]) > 0.0 &&
+                       dot(after, this->surface_normals[c]) > 0.0;
+            })
+        };
+
+        if(!unfolded)
+            return 0;
+
+        //a border has a single triangle along it, anything else has two
+        const VertexKind kind { this->kinds[from] };
+
+        if(moves.size() != (kind == VertexKind::border ? 1 : 2))
+            return 0;
+
+        //a seam only moves along itself, where vertexes differ across the edge, and anything else away from seams
+        if(moves.size() == 2 && (kind == VertexKind::seam) != (moves[0] != moves[1]))
+            return 0;
+
+        //each vertex at from must have a single place to go
+        for(auto const& [f, t] : moves)
+            for(auto const& [other_f, other_t] : moves)
+                if(f == other_f && t != other_t)
+                    return 0;
+
+        for(uint32_t v : moving)
+            if(std::none_of(moves.begin(), moves.end(), [v](const pair<uint32_t, uint32_t> &m){ return m.first == v; }))
+                return 0;
+
+        //only the triangles along the edge may share the two neighbours they join, or the surface pinches
+        for_each_triangle(to, [&](const array<uint32_t, 3> &, const array<uint32_t, 3> &tp){
+            for(uint32_t p : tp)
+                if(p != to)
+                    to_neighbours.push_back(p);
+            return true;
+        });
+
+        for(auto *neighbours : { &from_neighbours, &to_neighbours }){
+            std::sort(neighbours->begin(), neighbours->end());
+            neighbours->erase(std::unique(neighbours->begin(), neighbours->end()), neighbours->end());
+        }
+
+        vector<uint32_t> common {};
+        std::set_intersection(from_neighbours.begin(), from_neighbours.end(),
+                              to_neighbours.begin(), to_neighbours.end(), std::back_inserter(common));
+
+        if(common.size() != moves.size())
+            return 0;
+
+        for(auto const& [f, t] : moves)
+            remap[f] = t;
+
+        return moves.size();
+    } };
+
+    size_t removed {};
+
+    //should every collapse within the pass limit be turned down, the pass goes on up to the error limit
+    for(double limit : { pass_limit, error_limit }){
+
+        for(auto const& c : collapses){
+
+            if(c.error > limit || removed >= goal)
+                break;
+
+            if(touched[c.from] || touched[c.to])
+                continue;
+
+            const size_t collapsed { try_collapse(c.from, c.to) };
+            if(collapsed == 0)
+                continue;
+
+            touched[c.from] = touched[c.to] = true;
+            this->quadrics[c.to] += this->quadrics[c.from];
+            this->max_collapse_error = std::max(this->max_collapse_error, c.error);
+
+            removed += collapsed;
+        }
+
+        if(removed > 0)
+            break;
+    }
+
+    //the triangles left, with the moved corners
+    size_t kept {};
+
+    for(size_t i{}; i < this->indexes.size(); i += 3){
+
+        const array<uint32_t, 3> v { remap[this->indexes[i]], remap[this->indexes[i + 1]], remap[this->indexes[i + 2]] };
+
+        if(is_degenerate({ this->position[v[0]], this->position[v[1]], this->position[v[2]] }))
+            continue;
+
+        std::copy(v.begin(), v.end(), this->indexes.begin() + static_cast<std::ptrdiff_t>(3 * kept));
+        ++kept;
+    }
+
+    this->indexes.resize(3 * kept);
+
+    return triangles - kept;
+}
+
+size_t Simplifier::triangle_count() const {
+    return this->indexes.size() / 3;
+}
+
+double Simplifier::error() const {
+    return std::sqrt(this->max_collapse_error);
+}
+
+void Simplifier::simplify(size_t target, double max_error){
+
+    const double error_limit {
+        max_error > 0.0 ? max_error * max_error : std::numeric_limits<double>::infinity()
+    };
+
+    while(this->triangle_count() > target)
+        if(this->collapse_pass(target, error_limit) == 0)
+            break;
+}
+
+Mesh Simplifier::result() const {
+
+    const bool has_normals { this->mesh.normals.size() == this->mesh.vertexes.size() };
+    const bool has_text_coords { this->mesh.text_coords.size() == this->mesh.vertexes.size() };
+
+    static constexpr uint32_t UNMAPPED { UINT32_MAX };
+    vector<uint32_t> remap(this->mesh.vertexes.size(), UNMAPPED);
+
+    Mesh res {};
+    res.indexes.reserve(this->indexes.size());
+
+    for(uint32_t i : this->indexes){
+
+        if(remap[i] == UNMAPPED){
+
+            remap[i] = static_cast<uint32_t>(res.vertexes.size());
+            res.vertexes.push_back(this->mesh.vertexes[i]);
+
+            if(has_normals)
+                res.normals.push_back(this->mesh.normals[i]);
+
+            if(has_text_coords)
+                res.text_coords.push_back(this->mesh.text_coords[i]);
+        }
+
+        res.indexes.push_back(remap[i]);
+    }
+
+    return res;
+}
+
+
+
+ErrorCode simplify_writer(const string &in_fn, size_t target, const string &out_fn, const Options &options){
+
+    auto&& [code, mesh] { read_mesh(in_fn) };
+
+    if(code != ErrorCode::success)
+        return code;
+
+    if(mesh.vertexes.size() % 3 != 0 && !mesh.is_indexed())
+        return ErrorCode::invalid_file_formatting;
+
+    //attributes which don't cover every vertex are dropped, rather than welded wrongly
+    if(mesh.normals.size() != mesh.vertexes.size())
+        mesh.normals.clear();
+
+    if(mesh.text_coords.size() != mesh.vertexes.size())
+        mesh.text_coords.clear();
+
+    weld(mesh);
+
+    Simplifier simplifier { std::move(mesh) };
+
+    std::cout << in_fn << ": " << simplifier.triangle_count() << " triangles\n";
+
+    vector<uint64_t> level_triangles {};
+    size_t level_target { target };
+    double level_error { options.max_error };
+
+    for(unsigned level{}; level < options.lods; ++level){
+
+        simplifier.simplify(level_target, level_error);
+
+        //it can't be simplified any further
+        if(level > 0 && simplifier.triangle_count() == level_triangles.back())
+            break;
+
+        Mesh level_mesh { simplifier.result() };
+
+        if(!options.indexed)
+            expand_indexes(level_mesh);
+
+        const string level_fn { lod_filename(out_fn, level) };
+
+        const ErrorCode write_code { write_mesh(level_fn, level_mesh, options) };
+        if(write_code != ErrorCode::success)
+            return write_code;
+
+        std::cout << "  " << level_fn << ": " << simplifier.triangle_count()
+                  << " triangles, error " << simplifier.error() << '\n';
+
+        level_triangles.push_back(simplifier.triangle_count());
+
+        level_target = simplifier.triangle_count() / 2;
+        level_error *= 2.0;
+    }
+
+    if(options.lods > 1)
+        return write_lods_file(out_fn, level_triangles);
+
+    return ErrorCode::success;
+}
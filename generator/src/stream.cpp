@@ -0,0 +1,394 @@
+#include "stream.hpp"
+#include "mesh_writer.hpp"
+#include "meshlets.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using std::string;
+using std::vector;
+
+
+
+/**
+ * Rough memory taken by each vertex of a tile: its attributes, twice over while
+ * the workers' meshes are concatenated, and its encoded record
+ * Welding adds a hash table entry per vertex on top of that
+ */
+static constexpr size_t TILE_BYTES_PER_VERTEX { 2 * (2 * sizeof(CartPoint3d) + sizeof(CartPoint2d)) + 8 * sizeof(double) };
+static constexpr size_t WELD_BYTES_PER_VERTEX { 128 };
+
+using TileConsumer = std::function<ErrorCode(Mesh &tile)>;
+
+/**
+ * Bytes of output left queued to be written while the next tile is generated
+ * A quarter of the budget holds about the whole output of a tile, so that
+ * generation need not wait for the disk unless the disk is the slower of the two
+ */
+static size_t queue_budget(const Options &options){
+    return (static_cast<size_t>(options.memory) << 20) / 4;
+}
+
+//peak resident set size of the process so far, in bytes
+static size_t peak_rss(){
+
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters {};
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+
+    //Linux reports it in KiB
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/**
+ * Generate every unit a tile at a time, handing each tile to consume
+ * Returns the first error of consume along with the number of tiles
+ */
+static std::tuple<ErrorCode, size_t> for_each_tile(size_t count, const Options &options,
+                                                   const RangeGenerator &generate,
+                                                   const TileConsumer &consume){
+
+    const size_t budget { (static_cast<size_t>(options.memory) << 20) - queue_budget(options) };
+    const size_t bytes_per_vertex {
+        TILE_BYTES_PER_VERTEX + (options.indexed ? WELD_BYTES_PER_VERTEX : 0)
+    };
+
+    const unsigned threads { options.threads > 0 ? options.threads : default_thread_count() };
+
+    //the first tile only serves to estimate the size of a unit
+    size_t tile_units { std::min<size_t>(count, threads) };
+    size_t done {};
+    size_t vertexes {};
+    size_t tiles {};
+
+    while(done < count){
+
+        const size_t first_unit { done };
+
+        Mesh tile {
+            generate_parallel(
+                tile_units,
+                options.threads,
+                [&generate, first_unit](Mesh &m, size_t begin, size_t end){
+                    generate(m, first_unit + begin, first_unit + end);
+                }
+            )
+        };
+
+        done += tile_units;
+        vertexes += tile.vertexes.size();
+        ++tiles;
+
+        const ErrorCode code { consume(tile) };
+        if(code != ErrorCode::success)
+            return { code, tiles };
+
+        const double vertexes_per_unit {
+            std::max(static_cast<double>(vertexes) / static_cast<double>(done), 1.0)
+        };
+
+        const double units_in_budget {
+            static_cast<double>(budget) / (vertexes_per_unit * static_cast<double>(bytes_per_vertex))
+        };
+
+        tile_units = std::clamp<size_t>(static_cast<size_t>(units_in_budget), 1, std::max<size_t>(count - done, 1));
+    }
+
+    return { ErrorCode::success, tiles };
+}
+
+/**
+ * Tiles set aside on disk as they are generated, for output which needs the box of
+ * the whole mesh before any of it can be written, so that no tile is generated twice
+ * Each tile is stored as the sizes of its five vectors followed by their elements,
+ * and read back one at a time, in the order they were set aside, once all of them are
+ */
+class TileSpill {
+
+private:
+    string fn;
+    std::ofstream file;
+
+public:
+    TileSpill(const string &fn);
+    ~TileSpill();
+
+    TileSpill(const TileSpill&) = delete;
+    TileSpill& operator=(const TileSpill&) = delete;
+
+    bool is_open() const;
+
+    ErrorCode write(const Mesh &tile);
+    ErrorCode replay(const TileConsumer &consume);
+};
+
+template<typename T>
+static void write_elements(std::ofstream &file, const vector<T> &elements){
+
+    static_assert(std::is_trivially_copyable<T>::value);
+
+    file.write(reinterpret_cast<const char*>(elements.data()),
+               static_cast<std::streamsize>(elements.size() * sizeof(T)));
+}
+
+template<typename T>
+static bool read_elements(std::ifstream &file, vector<T> &elements, uint64_t count){
+
+    static_assert(std::is_trivially_copyable<T>::value);
+
+    elements.resize(count);
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(elements.data()),
+                                       static_cast<std::streamsize>(elements.size() * sizeof(T))));
+}
+
+TileSpill::TileSpill(const string &fn) :
+    fn(fn), file()
+{
+    this->file.open(fn, std::ios::out | std::ios::trunc | std::ios::binary);
+}
+
+TileSpill::~TileSpill(){
+    this->file.close();
+    std::remove(this->fn.c_str());
+}
+
+bool TileSpill::is_open() const {
+    return this->file.is_open();
+}
+
+ErrorCode TileSpill::write(const Mesh &tile){
+
+    const std::array<uint64_t, 5> sizes {
+        tile.vertexes.size(), tile.normals.size(), tile.text_coords.size(),
+        tile.indexes.size(), tile.meshlets.size()
+    };
+
+    this->file.write(reinterpret_cast<const char*>(sizes.data()), sizeof(sizes));
+
+    write_elements(this->file, tile.vertexes);
+    write_elements(this->file, tile.normals);
+    write_elements(this->file, tile.text_coords);
+    write_elements(this->file, tile.indexes);
+    write_elements(this->file, tile.meshlets);
+
+    return this->file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+ErrorCode TileSpill::replay(const TileConsumer &consume){
+
+    this->file.close();
+    if(this->file.fail())
+        return ErrorCode::io_error;
+
+    std::ifstream spilled {};
+    spilled.open(this->fn, std::ios::in | std::ios::binary);
+
+    if(!spilled.is_open())
+        return ErrorCode::io_error;
+
+    std::array<uint64_t, 5> sizes {};
+
+    while(spilled.read(reinterpret_cast<char*>(sizes.data()), sizeof(sizes))){
+
+        Mesh tile {};
+
+        const bool read {
+            read_elements(spilled, tile.vertexes, sizes[0]) &&
+            read_elements(spilled, tile.normals, sizes[1]) &&
+            read_elements(spilled, tile.text_coords, sizes[2]) &&
+            read_elements(spilled, tile.indexes, sizes[3]) &&
+            read_elements(spilled, tile.meshlets, sizes[4])
+        };
+
+        if(!read)
+            return ErrorCode::io_error;
+
+        const ErrorCode code { consume(tile) };
+        if(code != ErrorCode::success)
+            return code;
+    }
+
+    //the last tile must have ended right at the end of the file
+    return spilled.eof() && spilled.gcount() == 0 ? ErrorCode::success : ErrorCode::io_error;
+}
+
+static std::tuple<ErrorCode, size_t> stream_text(const string &filename, size_t count, const Options &options,
+                                                 const RangeGenerator &generate){
+
+    //the next tile is generated while the text of the previous ones is written
+    OutputSink sink { OutputSink::DEFAULT_BUFFER_SIZE, queue_budget(options) };
+
+    TextWriter vertexes_file { sink, filename };
+    TextWriter normals_file { sink, to_norm_extension(filename) };
+    TextWriter text_file { sink, to_text_extension(filename) };
+
+    TileSpill spill { filename + ".tiles" };
+
+    if(!vertexes_file.is_open() || !normals_file.is_open() || !text_file.is_open() || !spill.is_open())
+        return { ErrorCode::io_error, 0 };
+
+    //the sphere is centred on the box of the whole mesh, so tiles are set aside until it is known
+    Bounds bounds {};
+
+    auto const& [code, tiles] {
+        for_each_tile(count, options, generate,
+            [&bounds, &spill](Mesh &tile){
+                bounds.extend_box(tile.vertexes);
+                return spill.write(tile);
+            }
+        )
+    };
+
+    if(code != ErrorCode::success)
+        return { code, tiles };
+
+    bounds.center_sphere();
+
+    const ErrorCode replay_code {
+        spill.replay(
+            [&](Mesh &tile){
+
+                bounds.extend_sphere(tile.vertexes);
+
+                for(auto const& p : tile.vertexes)
+                    vertexes_file << p;
+
+                for(auto const& n : tile.normals)
+                    normals_file << n;
+
+                for(auto const& t : tile.text_coords)
+                    text_file << t;
+
+                return ErrorCode::success;
+            }
+        )
+    };
+
+    if(replay_code != ErrorCode::success)
+        return { replay_code, tiles };
+
+    const bool flushed { vertexes_file.flush() && normals_file.flush() && text_file.flush() };
+    if(!flushed)
+        return { ErrorCode::io_error, tiles };
+
+    return { write_bounds(to_bounds_extension(filename), bounds), tiles };
+}
+
+static std::tuple<ErrorCode, size_t> stream_binary(const string &filename, size_t count, const Options &options,
+                                                   const RangeGenerator &generate){
+
+    uint32_t flags {};
+    if(options.quantize > 0)
+        flags = MESH_FLAG_QUANTIZED | (options.quantize == 8 ? MESH_FLAG_NORMALS_8BIT : 0);
+    else if(options.single_precision)
+        flags = MESH_FLAG_SINGLE_PRECISION;
+
+    BinaryMeshWriter writer { filename, flags, queue_budget(options) };
+    if(!writer.is_open())
+        return { ErrorCode::io_error, 0 };
+
+    const auto prepare {
+        [&options](Mesh &tile){
+
+            if(options.indexed)
+                weld(tile);
+
+            if(options.meshlet_triangles > 0)
+                build_meshlets(tile, options.meshlet_vertexes, options.meshlet_triangles);
+        }
+    };
+
+    if(options.quantize == 0){
+
+        auto const& [code, tiles] {
+            for_each_tile(count, options, generate,
+                [&writer, &prepare](Mesh &tile){
+                    prepare(tile);
+                    return writer.write(tile);
+                }
+            )
+        };
+
+        if(code != ErrorCode::success)
+            return { code, tiles };
+
+        return { writer.close(), tiles };
+    }
+
+    //quantization ranges span the box of the whole mesh, so tiles are set aside until it is known
+    TileSpill spill { filename + ".tiles" };
+    if(!spill.is_open())
+        return { ErrorCode::io_error, 0 };
+
+    auto const& [code, tiles] {
+        for_each_tile(count, options, generate,
+            [&writer, &spill, &prepare](Mesh &tile){
+                prepare(tile);
+                writer.include_bounds(tile);
+                return spill.write(tile);
+            }
+        )
+    };
+
+    if(code != ErrorCode::success)
+        return { code, tiles };
+
+    const ErrorCode replay_code {
+        spill.replay(
+            [&writer](Mesh &tile){
+                return writer.write(tile);
+            }
+        )
+    };
+
+    if(replay_code != ErrorCode::success)
+        return { replay_code, tiles };
+
+    return { writer.close(), tiles };
+}
+
+ErrorCode stream_writer(const string &filename, size_t count, const Options &options,
+                        const RangeGenerator &generate){
+
+    auto const& [code, tiles] {
+        options.binary ?
+            stream_binary(filename, count, options, generate) :
+            stream_text(filename, count, options, generate)
+    };
+
+    if(code == ErrorCode::success)
+        std::cout << filename << ": " << tiles << " tiles, peak RSS "
+                  << peak_rss() / (1 << 20) << " MiB\n";
+
+    return code;
+}
+
+ErrorCode generate_mesh(const string &filename, size_t count, const Options &options,
+                        const RangeGenerator &generate){
+
+    if(options.memory > 0)
+        return stream_writer(filename, count, options, generate);
+
+    Mesh mesh { generate_parallel(count, options.threads, generate) };
+
+    return write_mesh(filename, mesh, options);
+}
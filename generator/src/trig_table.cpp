@@ -0,0 +1,25 @@
+#include "trig_table.hpp"
+
+#include <cmath>
+
+
+
+TrigTable::TrigTable(size_t count, angle_t start, angle_t step) :
+    sines(count + 1), cosines(count + 1)
+{
+    for(size_t i{}; i <= count; ++i){
+
+        const angle_t rad { degree_to_radian(start + step * static_cast<angle_t>(i)) };
+
+        this->sines[i] = std::sin(rad);
+        this->cosines[i] = std::cos(rad);
+    }
+}
+
+double TrigTable::sin(size_t i) const {
+    return this->sines[i];
+}
+
+double TrigTable::cos(size_t i) const {
+    return this->cosines[i];
+}
@@ -0,0 +1,52 @@
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <string>
+#include <vector>
+#include <tuple>
+
+#include "point.hpp"
+#include "error_code.hpp"
+
+
+/**
+ * Axis aligned bounding box and bounding sphere of a set of points
+ *
+ * The sphere is centred on the box, so it is found in two passes: the box is grown
+ * as the points are generated, then the sphere is centred and grown over them again.
+ * It isn't the minimal sphere, but it is for symmetric meshes (spheres, boxes, tori...)
+ * and, unlike single pass approximations, doesn't depend on the order of the points.
+ */
+struct Bounds {
+    CartPoint3d min;
+    CartPoint3d max;
+    CartPoint3d center;
+    double radius;
+    bool empty;
+
+    Bounds();
+
+    void extend_box(const CartPoint3d &p);
+    void extend_box(const std::vector<CartPoint3d> &points);
+
+    //the sphere about the centre of the box, with radius 0 until extended
+    void center_sphere();
+    void extend_sphere(const CartPoint3d &p);
+    void extend_sphere(const std::vector<CartPoint3d> &points);
+};
+
+//both passes over points
+Bounds points_bounds(const std::vector<CartPoint3d> &points);
+
+
+
+/**
+ * Text meshes keep their bounds in a .bounds file next to the .3d one, made up of the lines
+ *     min <x> <y> <z>
+ *     max <x> <y> <z>
+ *     sphere <x> <y> <z> <radius>
+ */
+ErrorCode write_bounds(const std::string &fn, const Bounds &bounds);
+std::tuple<ErrorCode, Bounds> read_bounds(const std::string &fn);
+
+#endif
@@ -10,6 +10,7 @@ enum ErrorCode {
     io_error,
     invalid_file_formatting,
     invalid_file_extension,
+    index_overflow,
 };
 
 void handle_error(const ErrorCode e);
@@ -14,5 +14,7 @@ bool has_patch_ext(const std::string &str);
 
 std::string to_norm_extension(const std::string &str);
 std::string to_text_extension(const std::string &str);
+std::string to_hash_extension(const std::string &str);
+std::string to_bounds_extension(const std::string &str);
 
 #endif
\ No newline at end of file
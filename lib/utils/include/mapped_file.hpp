@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+/**
+ * The whole contents of a file, read only
+ * Mapped into memory where mmap is available, so that nothing is copied,
+ * and read into a buffer otherwise
+ */
+class MappedFile {
+
+private:
+    const char *bytes;
+    size_t length;
+    bool open;
+
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+public:
+    MappedFile(const std::string &fn);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const;
+    const char* data() const;
+    const char* end() const;
+    size_t size() const;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <vector>
+#include <string>
+#include <array>
+#include <tuple>
+#include <fstream>
+#include <cstdint>
+
+#include "point.hpp"
+#include "error_code.hpp"
+#include "quantize.hpp"
+#include "bounds.hpp"
+#include "output_sink.hpp"
+
+
+
+/** Mesh **/
+
+/**
+ * A cluster of index_count / 3 consecutive triangles, starting at first_index
+ * (a position in indexes, or in vertexes if the mesh isn't indexed)
+ *
+ * The sphere holds every triangle of the cluster and the cone, of unit axis,
+ * holds their normals. cone_cutoff is the sine of the angle of the cone,
+ * so that the whole cluster faces away from any viewpoint v for which
+ *     dot(center - v, cone_axis) >= cone_cutoff * |center - v| + radius
+ * It is 1 if the cone is too wide for that to ever hold.
+ */
+struct Meshlet {
+    uint32_t first_index;
+    uint32_t index_count;
+    std::array<double, 3> center;
+    double radius;
+    std::array<double, 3> cone_axis;
+    double cone_cutoff;
+
+    Meshlet();
+    Meshlet(uint32_t first_index, uint32_t index_count);
+};
+
+static_assert(sizeof(Meshlet) == 72);
+
+/**
+ * Without indexes, a triangle soup: every three consecutive vertexes make up a triangle
+ * Otherwise, every three consecutive indexes do
+ * normals and text_coords are either empty or as long as vertexes
+ *
+ * meshlets, if any, partition the triangles. Only their ranges need be set,
+ * as their bounds are found from the positions as stored when written.
+ * weld and expand_indexes keep the order of the triangles, and thus the meshlets.
+ */
+struct Mesh {
+    std::vector<CartPoint3d> vertexes;
+    std::vector<CartPoint3d> normals;
+    std::vector<CartPoint2d> text_coords;
+    std::vector<uint32_t> indexes;
+    std::vector<Meshlet> meshlets;
+
+    Mesh();
+
+    bool is_indexed() const;
+    size_t triangle_count() const;
+};
+
+void weld(Mesh &mesh);
+void expand_indexes(Mesh &mesh);
+
+
+
+/** Binary mesh format **/
+
+/**
+ * A single file made up of a fixed size header followed by vertex_count
+ * interleaved records. Each record holds, in this order, the position, the normal
+ * and the texture coordinates of a vertex, if the respective bit is set in the
+ * attribute mask. Values are stored in native byte order, either as
+ * doubles or as floats if MESH_FLAG_SINGLE_PRECISION is set.
+ * The records are followed by index_count 32 bit indexes (since version 2)
+ * and then by meshlet_count Meshlets (since version 5).
+ *
+ * With MESH_FLAG_QUANTIZED set (since version 3), each record instead holds
+ * the position as three 16 bit integers over the bounding box, scaled alike along
+ * every axis by its longest side, the normal
+ * octahedral encoded as two 16 bit integers (8 bit if MESH_FLAG_NORMALS_8BIT is set)
+ * and the texture coordinates as two 16 bit integers over their own bounds.
+ * See QuantizationRange and oct_encode.
+ *
+ * Newer versions only ever append fields to the header,
+ * so older files are read with the missing fields zeroed.
+ */
+
+static constexpr std::array<char, 4> MESH_MAGIC { 'C', 'G', '3', 'D' };
+static constexpr uint32_t MESH_VERSION { 5 };
+
+static constexpr uint32_t MESH_ATTR_POSITION   { 1U << 0 };
+static constexpr uint32_t MESH_ATTR_NORMAL     { 1U << 1 };
+static constexpr uint32_t MESH_ATTR_TEXT_COORD { 1U << 2 };
+
+static constexpr uint32_t MESH_FLAG_SINGLE_PRECISION { 1U << 0 };
+static constexpr uint32_t MESH_FLAG_QUANTIZED        { 1U << 1 };
+static constexpr uint32_t MESH_FLAG_NORMALS_8BIT     { 1U << 2 };
+
+struct MeshHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint64_t vertex_count;
+    uint32_t attributes;
+    uint32_t flags;
+    uint64_t index_count;
+
+    //since version 3
+    std::array<double, 3> bounds_min;       //bounding box of the positions
+    std::array<double, 3> bounds_max;
+    std::array<double, 2> text_bounds_min;  //bounding box of the texture coordinates
+    std::array<double, 2> text_bounds_max;
+
+    //since version 4
+    std::array<double, 3> sphere_center;    //bounding sphere of the positions, see Bounds
+    double sphere_radius;
+
+    //since version 5
+    uint64_t meshlet_count;
+};
+
+static_assert(sizeof(MeshHeader) == 152);
+
+
+
+/**
+ * A quantized mesh as read from a file, laid out to be uploaded as is
+ * positions holds x, y and z, padded to 4 values per vertex for alignment
+ * normals holds x, y and z, decoded from their octahedral encoding and padded
+ * to 4 values per vertex, each value taking normal_bits bits
+ * text_coords holds s and t
+ * Each value is recovered as offset + q * scale, per component
+ */
+struct QuantizedMesh {
+    std::vector<int16_t> positions;
+    std::vector<char> normals;
+    std::vector<int16_t> text_coords;
+    std::vector<uint32_t> indexes;
+    std::vector<Meshlet> meshlets;
+
+    unsigned normal_bits;
+    std::array<QuantizationRange, 3> position_ranges;
+    std::array<QuantizationRange, 2> text_coord_ranges;
+
+    QuantizedMesh();
+
+    size_t vertex_count() const;
+};
+
+
+
+bool is_binary_mesh(const std::string &fn);
+bool is_quantized_mesh(const std::string &fn);
+
+ErrorCode write_binary_mesh(const std::string &fn, const Mesh &mesh, bool single_precision);
+ErrorCode write_quantized_mesh(const std::string &fn, const Mesh &mesh, unsigned normal_bits);
+
+/**
+ * Writes a binary mesh a piece at a time, so that only one piece need be in memory
+ * Indexes (and meshlets) of each piece are relative to the piece itself
+ * The header, with the final counts and bounds, is written by close
+ *
+ * Each piece is encoded and handed to an OutputSink, so write returns while
+ * it is being written, up to max_queued bytes ahead of the disk
+ *
+ * Quantized records depend on the bounds of the whole mesh,
+ * so each piece must first be given to include_bounds
+ */
+class BinaryMeshWriter {
+
+private:
+    std::string fn;
+    OutputSink sink;
+    size_t file;
+    size_t index_file;          //indexes set aside until every record is written, once any are
+    MeshHeader header;
+    std::vector<Meshlet> meshlets;  //small enough to be kept until every index is written
+    Bounds bounds;              //only the box until close, which also finds the sphere
+
+    std::string index_file_name() const;
+
+public:
+    BinaryMeshWriter(const std::string &fn, uint32_t flags,
+                     size_t max_queued = OutputSink::DEFAULT_MAX_QUEUED);
+    ~BinaryMeshWriter();
+
+    bool is_open() const;
+
+    void include_bounds(const Mesh &piece);
+    ErrorCode write(const Mesh &piece);
+    ErrorCode close();
+};
+
+//quantized files are dequantized when read as a Mesh
+std::tuple<ErrorCode, Mesh> read_binary_mesh(const std::string &fn);
+std::tuple<ErrorCode, QuantizedMesh> read_quantized_mesh(const std::string &fn);
+std::tuple<ErrorCode, MeshHeader> read_binary_mesh_header(const std::string &fn);
+
+//the bounds stored in header, empty if it predates them (version 3 only stores the box)
+Bounds header_bounds(const MeshHeader &header);
+
+#endif
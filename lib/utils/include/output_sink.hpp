@@ -0,0 +1,79 @@
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+
+/**
+ * Writes buffers to its files on an I/O thread of its own, so that whoever fills
+ * them carries on (generating, formatting, encoding) while earlier ones are written
+ *
+ * Buffers are written in the order they are submitted, whichever file they go to.
+ * Once max_queued bytes are waiting to be written, submit blocks until the
+ * I/O thread catches up, so that a slow disk holds back producers instead of
+ * letting them fill up memory. A single buffer larger than that is still taken,
+ * once nothing else is queued.
+ *
+ * Write errors are kept until flush or close, which report them.
+ * Files are opened and buffers submitted from a single thread.
+ */
+class OutputSink {
+
+private:
+    struct Write {
+        std::ofstream *file;
+        std::vector<char> buffer;
+        size_t size;
+    };
+
+    std::deque<std::ofstream> files;    //never moved, so that queued writes can point into it
+    std::deque<Write> queue;
+    std::vector<std::vector<char>> spare;   //written buffers, kept to be acquired again
+    size_t buffer_size;
+    size_t max_queued;
+    size_t queued;          //bytes submitted and not yet written, including the current write
+    bool writing;
+    bool failed;
+    bool stopping;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable space_ready;
+    std::thread thread;
+
+    void run();
+    void wait_idle(std::unique_lock<std::mutex> &lock);
+
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE { 1 << 20 };
+    static constexpr size_t DEFAULT_MAX_QUEUED { 16 << 20 };
+
+    OutputSink(size_t buffer_size = DEFAULT_BUFFER_SIZE, size_t max_queued = DEFAULT_MAX_QUEUED);
+    ~OutputSink();
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    //returns the id of the file, for submit and close, whether or not it could be opened
+    size_t open(const std::string &fn, std::ios::openmode mode = std::ios::out | std::ios::trunc);
+    bool is_open(size_t file) const;
+
+    //a buffer of buffer_size bytes, either new or one already written
+    std::vector<char> acquire();
+
+    //queue the first size bytes of buffer to be appended to file, blocking while too much is queued
+    void submit(size_t file, std::vector<char> &&buffer, size_t size);
+
+    //wait until everything submitted is written, and whether it all was
+    bool flush();
+    bool close(size_t file);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef QUANTIZE_HPP
+#define QUANTIZE_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "point.hpp"
+
+
+//largest magnitude of a quantized value, leaving -32768 out so that the range is symmetric
+static constexpr int16_t QUANTIZED_MAX { 32767 };
+
+/**
+ * Maps [min, max] onto [-QUANTIZED_MAX, QUANTIZED_MAX], so that a value
+ * is recovered as offset + q * scale, which is what lets a fixed function
+ * pipeline dequantize with a translation followed by a scale
+ */
+struct QuantizationRange {
+    double offset;
+    double scale;
+
+    QuantizationRange();
+    QuantizationRange(double min, double max);
+
+    int16_t quantize(double value) const;
+    double dequantize(int16_t q) const;
+};
+
+
+/**
+ * Octahedral encoding of unit vectors into two signed integers of the given bits
+ * The sphere is projected onto an octahedron, whose lower half is folded
+ * over the upper one, giving an even distribution over the square [-1, 1]^2
+ * Each component is rounded so as to minimize the decoded vector's angular error
+ */
+std::array<int16_t, 2> oct_encode(const CartPoint3d &n, unsigned bits);
+CartPoint3d oct_decode(int16_t x, int16_t y, unsigned bits);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TEXT_READER_HPP
+#define TEXT_READER_HPP
+
+#include <string>
+#include <tuple>
+
+#include "error_code.hpp"
+#include "mesh.hpp"
+
+
+/**
+ * Read a text mesh, split into the .3d, .norm and .text files sharing fn's name
+ * The codes returned are those of each of the three files, in that order
+ * Large files are split among at most threads threads, this one included, or one per core if 0,
+ * which callers already reading several meshes at once lower to the cores they leave idle
+ */
+std::tuple<ErrorCode, ErrorCode, ErrorCode, Mesh> read_text_mesh(const std::string &fn, unsigned threads = 0);
+
+/**
+ * Read a mesh, either binary or a text one
+ * The normals and texture coordinates of text meshes are optional, so only the .3d file need be there
+ */
+std::tuple<ErrorCode, Mesh> read_mesh(const std::string &fn);
+
+#endif
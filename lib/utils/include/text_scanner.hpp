@@ -0,0 +1,80 @@
+#ifndef TEXT_SCANNER_HPP
+#define TEXT_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * Reads numbers and punctuation off a buffer of text in place, without allocating,
+ * keeping track of the line and column it is at for error messages
+ *
+ * Blanks are spaces, tabs and carriage returns, whitespace also takes in line breaks.
+ * The read functions leave the scanner where it was if there is no number to read,
+ * so that errors point at the offending text.
+ */
+class TextScanner {
+
+private:
+    const char *pos;
+    const char *last;
+    const char *line_start;
+    size_t line_num;
+
+    static bool is_blank(char c){
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+public:
+    TextScanner(const char *begin, const char *end);
+
+    bool at_end() const { return this->pos == this->last; }
+
+    //the next character, or '\0' at the end
+    char peek() const { return this->at_end() ? '\0' : *this->pos; }
+
+    size_t line() const { return this->line_num; }
+    size_t column() const { return static_cast<size_t>(this->pos - this->line_start) + 1; }
+
+    void skip_blanks(){
+        while(!this->at_end() && is_blank(*this->pos))
+            ++this->pos;
+    }
+
+    //true if a line break was skipped
+    bool skip_line_break(){
+
+        if(this->peek() != '\n')
+            return false;
+
+        ++this->pos;
+        ++this->line_num;
+        this->line_start = this->pos;
+
+        return true;
+    }
+
+    void skip_whitespace(){
+        do
+            this->skip_blanks();
+        while(this->skip_line_break());
+    }
+
+    //true if c was next, and thus skipped
+    bool accept(char c){
+
+        if(this->peek() != c)
+            return false;
+
+        ++this->pos;
+        return true;
+    }
+
+    //an optionally '+' signed integer of at most max
+    bool read_uint(uint64_t &value, uint64_t max);
+
+    //a decimal number, as in strtod, but with no infinities or NaNs
+    bool read_double(double &value);
+};
+
+#endif
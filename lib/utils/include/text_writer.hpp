@@ -0,0 +1,48 @@
+#ifndef TEXT_WRITER_HPP
+#define TEXT_WRITER_HPP
+
+#include <string>
+#include <vector>
+
+#include "point.hpp"
+#include "output_sink.hpp"
+
+
+/**
+ * Writes points in the same "x; y; z" line format as operator<<,
+ * but with each number formatted by std::to_chars as the shortest string
+ * that reads back to the exact same double
+ *
+ * Text is accumulated in a large buffer which is only handed to the sink
+ * once full (and on flush or destruction), to be written while the next one fills.
+ * The sink must outlive the writer.
+ */
+class TextWriter {
+
+private:
+    OutputSink &sink;
+    size_t file;
+    std::vector<char> buffer;
+    size_t used;
+
+    void submit();
+    void reserve(size_t size);
+    void put(double d);
+
+public:
+    TextWriter(OutputSink &sink, const std::string &fn);
+    ~TextWriter();
+
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    bool is_open() const;
+
+    //wait until every point so far is written (along with everything else in the sink)
+    bool flush();
+
+    TextWriter& operator<<(const CartPoint3d &p);
+    TextWriter& operator<<(const CartPoint2d &p);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using std::string;
+using std::vector;
+using std::tuple;
+
+
+
+Bounds::Bounds() :
+    min(), max(), center(), radius(0.0), empty(true) {}
+
+void Bounds::extend_box(const CartPoint3d &p){
+
+    if(this->empty){
+        this->min = this->max = p;
+        this->empty = false;
+        return;
+    }
+
+    this->min = { std::min(this->min.x, p.x), std::min(this->min.y, p.y), std::min(this->min.z, p.z) };
+    this->max = { std::max(this->max.x, p.x), std::max(this->max.y, p.y), std::max(this->max.z, p.z) };
+}
+
+void Bounds::extend_box(const vector<CartPoint3d> &points){
+    for(auto const& p : points)
+        this->extend_box(p);
+}
+
+void Bounds::center_sphere(){
+
+    this->center = {
+        (this->min.x + this->max.x) / 2.0,
+        (this->min.y + this->max.y) / 2.0,
+        (this->min.z + this->max.z) / 2.0
+    };
+    this->radius = 0.0;
+}
+
+void Bounds::extend_sphere(const CartPoint3d &p){
+
+    const double dx { p.x - this->center.x };
+    const double dy { p.y - this->center.y };
+    const double dz { p.z - this->center.z };
+
+    this->radius = std::max(this->radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+}
+
+void Bounds::extend_sphere(const vector<CartPoint3d> &points){
+    for(auto const& p : points)
+        this->extend_sphere(p);
+}
+
+Bounds points_bounds(const vector<CartPoint3d> &points){
+
+    Bounds bounds {};
+    bounds.extend_box(points);
+    bounds.center_sphere();
+    bounds.extend_sphere(points);
+
+    return bounds;
+}
+
+
+
+ErrorCode write_bounds(const string &fn, const Bounds &bounds){
+
+    std::ofstream file{};
+    file.open(fn, std::ios::out | std::ios::trunc);
+
+    if(!file.is_open())
+        return ErrorCode::io_error;
+
+    //enough digits for every double to read back the same
+    file << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    file << "min " << bounds.min.x << ' ' << bounds.min.y << ' ' << bounds.min.z << '\n';
+    file << "max " << bounds.max.x << ' ' << bounds.max.y << ' ' << bounds.max.z << '\n';
+    file << "sphere " << bounds.center.x << ' ' << bounds.center.y << ' ' << bounds.center.z << ' '
+         << bounds.radius << '\n';
+
+    return file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+tuple<ErrorCode, Bounds> read_bounds(const string &fn){
+
+    Bounds bounds {};
+
+    std::ifstream file{};
+    file.open(fn, std::ios::in);
+
+    if(!file.is_open())
+        return { ErrorCode::io_error, bounds };
+
+    string min_key {}, max_key {}, sphere_key {};
+
+    file >> min_key >> bounds.min.x >> bounds.min.y >> bounds.min.z;
+    file >> max_key >> bounds.max.x >> bounds.max.y >> bounds.max.z;
+    file >> sphere_key >> bounds.center.x >> bounds.center.y >> bounds.center.z >> bounds.radius;
+
+    if(!file || min_key != "min" || max_key != "max" || sphere_key != "sphere")
+        return { ErrorCode::invalid_file_formatting, Bounds{} };
+
+    bounds.empty = false;
+
+    return { ErrorCode::success, bounds };
+}
@@ -102,3 +102,11 @@ string to_norm_extension(const string &str){
 string to_text_extension(const string &str){
     return replace_extension(str, ".text");
 }
+
+string to_hash_extension(const string &str){
+    return replace_extension(str, ".hash");
+}
+
+string to_bounds_extension(const string &str){
+    return replace_extension(str, ".bounds");
+}
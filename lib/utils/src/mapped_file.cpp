@@ -0,0 +1,99 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string &fn) :
+    bytes(nullptr), length(0), open(false), buffer()
+{
+    std::ifstream file{};
+    file.open(fn, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if(!file.is_open())
+        return;
+
+    this->buffer.resize(static_cast<size_t>(file.tellg()));
+
+    file.seekg(0);
+    if(!file.read(this->buffer.data(), static_cast<std::streamsize>(this->buffer.size())))
+        return;
+
+    this->bytes = this->buffer.data();
+    this->length = this->buffer.size();
+    this->open = true;
+}
+
+MappedFile::~MappedFile(){}
+
+#else
+
+MappedFile::MappedFile(const string &fn) :
+    bytes(nullptr), length(0), open(false)
+{
+    const int fd { ::open(fn.c_str(), O_RDONLY) };
+    if(fd < 0)
+        return;
+
+    struct stat info {};
+
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode)){
+
+        this->length = static_cast<size_t>(info.st_size);
+
+        //empty files can't be mapped, but are read all the same
+        if(this->length == 0)
+            this->open = true;
+
+        else{
+            void *address { mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0) };
+
+            if(address != MAP_FAILED){
+                //files are read front to back, so the kernel may read ahead aggressively
+                madvise(address, this->length, MADV_SEQUENTIAL);
+
+                this->bytes = static_cast<const char*>(address);
+                this->open = true;
+            }
+            else
+                this->length = 0;
+        }
+    }
+
+    //the mapping outlives the descriptor
+    ::close(fd);
+}
+
+MappedFile::~MappedFile(){
+    if(this->bytes != nullptr)
+        munmap(const_cast<char*>(this->bytes), this->length);
+}
+
+#endif
+
+bool MappedFile::is_open() const {
+    return this->open;
+}
+
+const char* MappedFile::data() const {
+    return this->bytes;
+}
+
+const char* MappedFile::end() const {
+    return this->bytes + this->length;
+}
+
+size_t MappedFile::size() const {
+    return this->length;
+}
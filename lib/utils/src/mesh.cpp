@@ -0,0 +1,1114 @@
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::tuple;
+using std::array;
+
+
+
+Meshlet::Meshlet() :
+    first_index(0), index_count(0), center(), radius(0.0), cone_axis(), cone_cutoff(1.0) {}
+
+Meshlet::Meshlet(uint32_t first_index, uint32_t index_count) :
+    first_index(first_index), index_count(index_count), center(), radius(0.0), cone_axis(), cone_cutoff(1.0) {}
+
+
+
+Mesh::Mesh() :
+    vertexes(), normals(), text_coords(), indexes(), meshlets() {}
+
+bool Mesh::is_indexed() const {
+    return this->indexes.size() > 0;
+}
+
+size_t Mesh::triangle_count() const {
+    return (this->is_indexed() ? this->indexes.size() : this->vertexes.size()) / 3;
+}
+
+
+
+QuantizedMesh::QuantizedMesh() :
+    positions(), normals(), text_coords(), indexes(), meshlets(),
+    normal_bits(16), position_ranges(), text_coord_ranges() {}
+
+size_t QuantizedMesh::vertex_count() const {
+    return this->positions.size() / 4;
+}
+
+
+
+//every attribute of a vertex, as compared when welding
+struct VertexKey {
+    std::array<double, 8> values;
+
+    bool operator==(const VertexKey &other) const {
+        return this->values == other.values;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey &key) const {
+
+        //FNV-1a over the raw bytes
+        uint64_t hash { 14695981039346656037ULL };
+
+        for(double d : key.values){
+
+            uint64_t bits {};
+            std::memcpy(&bits, &d, sizeof(bits));
+
+            for(unsigned i{}; i < sizeof(bits); ++i, bits >>= 8){
+                hash ^= bits & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        return static_cast<size_t>(hash);
+    }
+};
+
+static VertexKey vertex_key(const Mesh &mesh, size_t i){
+
+    const bool has_normals { mesh.normals.size() == mesh.vertexes.size() };
+    const bool has_text_coords { mesh.text_coords.size() == mesh.vertexes.size() };
+
+    const CartPoint3d &v { mesh.vertexes[i] };
+    const CartPoint3d n { has_normals ? mesh.normals[i] : CartPoint3d{} };
+    const CartPoint2d t { has_text_coords ? mesh.text_coords[i] : CartPoint2d{} };
+
+    //adding 0.0 turns -0.0 into 0.0, so that both hash alike
+    return {
+        {
+            v.x + 0.0, v.y + 0.0, v.z + 0.0,
+            n.x + 0.0, n.y + 0.0, n.z + 0.0,
+            t.x + 0.0, t.y + 0.0
+        }
+    };
+}
+
+//merge vertexes whose position, normal and texture coordinates are all equal
+void weld(Mesh &mesh){
+
+    if(mesh.is_indexed())
+        expand_indexes(mesh);
+
+    const bool has_normals { mesh.normals.size() == mesh.vertexes.size() };
+    const bool has_text_coords { mesh.text_coords.size() == mesh.vertexes.size() };
+
+    Mesh welded {};
+    welded.indexes.reserve(mesh.vertexes.size());
+
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique_vertexes {};
+    unique_vertexes.reserve(mesh.vertexes.size() / 4);
+
+    for(size_t i{}; i < mesh.vertexes.size(); ++i){
+
+        const uint32_t next_index { static_cast<uint32_t>(welded.vertexes.size()) };
+        auto const& [iter, inserted] { unique_vertexes.try_emplace(vertex_key(mesh, i), next_index) };
+
+        if(inserted){
+            welded.vertexes.push_back(mesh.vertexes[i]);
+
+            if(has_normals)
+                welded.normals.push_back(mesh.normals[i]);
+
+            if(has_text_coords)
+                welded.text_coords.push_back(mesh.text_coords[i]);
+        }
+
+        welded.indexes.push_back(iter->second);
+    }
+
+    welded.meshlets = std::move(mesh.meshlets);
+    mesh = std::move(welded);
+}
+
+//turn an indexed mesh back into a triangle soup
+void expand_indexes(Mesh &mesh){
+
+    if(!mesh.is_indexed())
+        return;
+
+    const bool has_normals { mesh.normals.size() == mesh.vertexes.size() };
+    const bool has_text_coords { mesh.text_coords.size() == mesh.vertexes.size() };
+
+    Mesh soup {};
+    soup.vertexes.reserve(mesh.indexes.size());
+
+    for(uint32_t i : mesh.indexes){
+
+        soup.vertexes.push_back(mesh.vertexes.at(i));
+
+        if(has_normals)
+            soup.normals.push_back(mesh.normals[i]);
+
+        if(has_text_coords)
+            soup.text_coords.push_back(mesh.text_coords[i]);
+    }
+
+    soup.meshlets = std::move(mesh.meshlets);
+    mesh = std::move(soup);
+}
+
+
+
+template<typename T>
+static inline void put(char* &dst, double value){
+    const T v { static_cast<T>(value) };
+    std::memcpy(dst, &v, sizeof(T));
+    dst += sizeof(T);
+}
+
+template<typename T>
+static inline double get(const char* &src){
+    T v {};
+    std::memcpy(&v, src, sizeof(T));
+    src += sizeof(T);
+    return static_cast<double>(v);
+}
+
+static unsigned normal_bits(uint32_t flags){
+    return (flags & MESH_FLAG_NORMALS_8BIT) ? 8 : 16;
+}
+
+static size_t record_size(uint32_t attributes, uint32_t flags){
+
+    if(flags & MESH_FLAG_QUANTIZED){
+
+        size_t size { 3 * sizeof(int16_t) };
+        if(attributes & MESH_ATTR_NORMAL)
+            size += 2 * normal_bits(flags) / 8;
+        if(attributes & MESH_ATTR_TEXT_COORD)
+            size += 2 * sizeof(int16_t);
+
+        return size;
+    }
+
+    const size_t scalar_size {
+        (flags & MESH_FLAG_SINGLE_PRECISION) ? sizeof(float) : sizeof(double)
+    };
+
+    size_t scalars {};
+    if(attributes & MESH_ATTR_POSITION)
+        scalars += 3;
+    if(attributes & MESH_ATTR_NORMAL)
+        scalars += 3;
+    if(attributes & MESH_ATTR_TEXT_COORD)
+        scalars += 2;
+
+    return scalars * scalar_size;
+}
+
+//size of the header as written by each version of the format
+static size_t header_size(uint32_t version){
+
+    switch(version){
+
+    case 1:
+        return 24;
+
+    case 2:
+        return 32;
+
+    case 3:
+        return 112;
+
+    case 4:
+        return 144;
+
+    case 5:
+        return 152;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Dequantizing positions scales them, and normals along with them by the inverse scale,
+ * which only keeps normals pointing the same way if every axis is scaled alike
+ * Each axis keeps its own offset, so the shorter ones merely use fewer of their steps
+ */
+static array<QuantizationRange, 3> position_ranges(const MeshHeader &header){
+
+    array<QuantizationRange, 3> ranges {
+        QuantizationRange{ header.bounds_min[0], header.bounds_max[0] },
+        QuantizationRange{ header.bounds_min[1], header.bounds_max[1] },
+        QuantizationRange{ header.bounds_min[2], header.bounds_max[2] }
+    };
+
+    const double longest {
+        std::max({
+            header.bounds_max[0] - header.bounds_min[0],
+            header.bounds_max[1] - header.bounds_min[1],
+            header.bounds_max[2] - header.bounds_min[2]
+        })
+    };
+
+    const QuantizationRange uniform { 0.0, longest };
+
+    for(auto& r : ranges)
+        r.scale = uniform.scale;
+
+    return ranges;
+}
+
+static array<QuantizationRange, 2> text_coord_ranges(const MeshHeader &header){
+    return {
+        QuantizationRange{ header.text_bounds_min[0], header.text_bounds_max[0] },
+        QuantizationRange{ header.text_bounds_min[1], header.text_bounds_max[1] }
+    };
+}
+
+
+
+/**
+ * Fill header in from the first size bytes of a file, checking it is well formed
+ * Returns the size of the header as stored in the file, or 0 if it isn't valid
+ */
+static size_t parse_header(const char *data, size_t size, MeshHeader &header){
+
+    header = MeshHeader{};
+
+    if(size < header_size(1))
+        return 0;
+
+    std::memcpy(&header, data, header_size(1));
+
+    const size_t hdr_size { header_size(header.version) };
+
+    if(header.magic != MESH_MAGIC ||
+       hdr_size == 0 ||
+       size < hdr_size ||
+       !(header.attributes & MESH_ATTR_POSITION)
+    )
+        return 0;
+
+    std::memcpy(&header, data, hdr_size);
+
+    //quantized files need the bounds only found in version 3 onwards
+    if(((header.flags & MESH_FLAG_QUANTIZED) && header.version < 3) ||
+       ((header.flags & MESH_FLAG_NORMALS_8BIT) && !(header.flags & MESH_FLAG_QUANTIZED))
+    )
+        return 0;
+
+    return hdr_size;
+}
+
+
+
+// true if fn starts with the binary mesh magic number
+bool is_binary_mesh(const string &fn){
+
+    std::ifstream file{};
+    file.open(fn, std::ios::in | std::ios::binary);
+
+    std::array<char, 4> magic {};
+
+    return
+        file.is_open() &&
+        file.read(magic.data(), magic.size()) &&
+        magic == MESH_MAGIC;
+}
+
+// true if fn is a binary mesh storing quantized records
+bool is_quantized_mesh(const string &fn){
+
+    auto const& [code, header] { read_binary_mesh_header(fn) };
+
+    return code == ErrorCode::success && (header.flags & MESH_FLAG_QUANTIZED);
+}
+
+static uint32_t mesh_attributes(const Mesh &mesh){
+
+    uint32_t attributes { MESH_ATTR_POSITION };
+
+    if(mesh.normals.size() == mesh.vertexes.size() && mesh.normals.size() > 0)
+        attributes |= MESH_ATTR_NORMAL;
+
+    if(mesh.text_coords.size() == mesh.vertexes.size() && mesh.text_coords.size() > 0)
+        attributes |= MESH_ATTR_TEXT_COORD;
+
+    return attributes;
+}
+
+//grow the box of bounds to contain mesh, along with the texture coordinate bounds in header, storing both in header
+static void extend_bounds(MeshHeader &header, Bounds &bounds, const Mesh &mesh){
+
+    if(mesh.vertexes.size() == 0)
+        return;
+
+    //every piece has texture coordinates if the first one does
+    if((header.attributes & MESH_ATTR_TEXT_COORD) && mesh.text_coords.size() > 0){
+
+        if(bounds.empty){
+            const CartPoint2d &first { mesh.text_coords.front() };
+            header.text_bounds_min = header.text_bounds_max = { first.x, first.y };
+        }
+
+        for(auto const& t : mesh.text_coords){
+            header.text_bounds_min = { std::min(header.text_bounds_min[0], t.x), std::min(header.text_bounds_min[1], t.y) };
+            header.text_bounds_max = { std::max(header.text_bounds_max[0], t.x), std::max(header.text_bounds_max[1], t.y) };
+        }
+    }
+
+    bounds.extend_box(mesh.vertexes);
+
+    header.bounds_min = bounds.min.as_array();
+    header.bounds_max = bounds.max.as_array();
+}
+
+//position of the record at src, as stored
+static CartPoint3d record_position(const char *src, const MeshHeader &header,
+                                   const array<QuantizationRange, 3> &pos_ranges){
+
+    if(header.flags & MESH_FLAG_QUANTIZED){
+        const double x { pos_ranges[0].dequantize(static_cast<int16_t>(get<int16_t>(src))) };
+        const double y { pos_ranges[1].dequantize(static_cast<int16_t>(get<int16_t>(src))) };
+        const double z { pos_ranges[2].dequantize(static_cast<int16_t>(get<int16_t>(src))) };
+        return { x, y, z };
+    }
+
+    if(header.flags & MESH_FLAG_SINGLE_PRECISION){
+        const double x { get<float>(src) };
+        const double y { get<float>(src) };
+        const double z { get<float>(src) };
+        return { x, y, z };
+    }
+
+    const double x { get<double>(src) };
+    const double y { get<double>(src) };
+    const double z { get<double>(src) };
+    return { x, y, z };
+}
+
+/**
+ * Grow the sphere in header, centred on its box, over count encoded records
+ * Positions are taken as stored, so that the sphere holds them once rounded
+ */
+static void extend_sphere(MeshHeader &header, const char *records, size_t count){
+
+    Bounds bounds {};
+    bounds.extend_box(CartPoint3d{ header.bounds_min[0], header.bounds_min[1], header.bounds_min[2] });
+    bounds.extend_box(CartPoint3d{ header.bounds_max[0], header.bounds_max[1], header.bounds_max[2] });
+    bounds.center_sphere();
+    bounds.radius = header.sphere_radius;
+
+    const array<QuantizationRange, 3> pos_ranges { position_ranges(header) };
+    const size_t rec_size { record_size(header.attributes, header.flags) };
+
+    for(size_t i{}; i < count; ++i)
+        bounds.extend_sphere(record_position(records + i * rec_size, header, pos_ranges));
+
+    header.sphere_center = bounds.center.as_array();
+    header.sphere_radius = bounds.radius;
+}
+
+static inline double dot(const CartPoint3d &a, const CartPoint3d &b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * Find the sphere and normal cone of meshlet from the positions of the encoded records
+ * Its first_index is taken relative to indexes, or to records if these are empty
+ */
+static void meshlet_bounds(Meshlet &meshlet, const MeshHeader &header, const char *records,
+                           const vector<uint32_t> &indexes){
+
+    const array<QuantizationRange, 3> pos_ranges { position_ranges(header) };
+    const size_t rec_size { record_size(header.attributes, header.flags) };
+
+    vector<CartPoint3d> corners(meshlet.index_count);
+
+    for(size_t i{}; i < meshlet.index_count; ++i){
+
+        const size_t at { meshlet.first_index + i };
+        const size_t vertex { indexes.size() > 0 ? indexes[at] : at };
+
+        corners[i] = record_position(records + vertex * rec_size, header, pos_ranges);
+    }
+
+    const Bounds bounds { points_bounds(corners) };
+    meshlet.center = bounds.center.as_array();
+    meshlet.radius = bounds.radius;
+
+    //triangles with no area have no normal, and are never drawn anyway
+    vector<CartPoint3d> normals {};
+    normals.reserve(corners.size() / 3);
+
+    CartPoint3d sum {};
+
+    for(size_t i{}; i + 2 < corners.size(); i += 3){
+
+        const CartPoint3d n {
+            cross_product(corners[i + 1] - corners[i], corners[i + 2] - corners[i])
+        };
+
+        if(dot(n, n) > 0.0){
+            normals.push_back(n.normalize());
+            sum += normals.back();
+        }
+    }
+
+    meshlet.cone_axis = {};
+    meshlet.cone_cutoff = 1.0;
+
+    if(normals.empty() || dot(sum, sum) == 0.0)
+        return;
+
+    const CartPoint3d axis { sum.normalize() };
+
+    double min_dot { 1.0 };
+    for(auto const& n : normals)
+        min_dot = std::min(min_dot, dot(axis, n));
+
+    meshlet.cone_axis = axis.as_array();
+
+    //a cone of 90 degrees or more always has some triangle facing the viewer
+    if(min_dot > 0.0)
+        meshlet.cone_cutoff = std::sqrt(1.0 - min_dot * min_dot);
+}
+
+static MeshHeader empty_header(uint32_t attributes, uint32_t flags){
+
+    MeshHeader header {};
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.attributes = attributes;
+    header.flags = flags;
+
+    return header;
+}
+
+//header describing mesh, including its bounding box
+static MeshHeader make_header(const Mesh &mesh, uint32_t flags){
+
+    MeshHeader header { empty_header(mesh_attributes(mesh), flags) };
+    header.vertex_count = mesh.vertexes.size();
+    header.index_count = mesh.indexes.size();
+    header.meshlet_count = mesh.meshlets.size();
+
+    Bounds bounds {};
+    extend_bounds(header, bounds, mesh);
+
+    return header;
+}
+
+template<typename T>
+static void encode_records(char *dst, const Mesh &mesh, uint32_t attributes){
+
+    for(size_t i{}; i < mesh.vertexes.size(); ++i){
+
+        const CartPoint3d &v { mesh.vertexes[i] };
+        put<T>(dst, v.x);
+        put<T>(dst, v.y);
+        put<T>(dst, v.z);
+
+        if(attributes & MESH_ATTR_NORMAL){
+            const CartPoint3d &n { mesh.normals[i] };
+            put<T>(dst, n.x);
+            put<T>(dst, n.y);
+            put<T>(dst, n.z);
+        }
+
+        if(attributes & MESH_ATTR_TEXT_COORD){
+            const CartPoint2d &t { mesh.text_coords[i] };
+            put<T>(dst, t.x);
+            put<T>(dst, t.y);
+        }
+    }
+}
+
+static void encode_quantized_records(char *dst, const Mesh &mesh, const MeshHeader &header){
+
+    const array<QuantizationRange, 3> pos_ranges { position_ranges(header) };
+    const array<QuantizationRange, 2> text_ranges { text_coord_ranges(header) };
+    const unsigned bits { normal_bits(header.flags) };
+
+    for(size_t i{}; i < mesh.vertexes.size(); ++i){
+
+        const CartPoint3d &v { mesh.vertexes[i] };
+        put<int16_t>(dst, pos_ranges[0].quantize(v.x));
+        put<int16_t>(dst, pos_ranges[1].quantize(v.y));
+        put<int16_t>(dst, pos_ranges[2].quantize(v.z));
+
+        if(header.attributes & MESH_ATTR_NORMAL){
+
+            const array<int16_t, 2> oct { oct_encode(mesh.normals[i], bits) };
+
+            if(bits == 8){
+                put<int8_t>(dst, oct[0]);
+                put<int8_t>(dst, oct[1]);
+            }
+            else{
+                put<int16_t>(dst, oct[0]);
+                put<int16_t>(dst, oct[1]);
+            }
+        }
+
+        if(header.attributes & MESH_ATTR_TEXT_COORD){
+            const CartPoint2d &t { mesh.text_coords[i] };
+            put<int16_t>(dst, text_ranges[0].quantize(t.x));
+            put<int16_t>(dst, text_ranges[1].quantize(t.y));
+        }
+    }
+}
+
+//header, then the already encoded records, then the indexes and the meshlets
+static ErrorCode write_mesh_file(const string &fn, const MeshHeader &header, const vector<char> &body,
+                                 const vector<uint32_t> &indexes, const vector<Meshlet> &meshlets){
+
+    std::ofstream file{};
+    file.open(fn, std::ios::out | std::ios::trunc | std::ios::binary);
+
+    if(!file.is_open())
+        return ErrorCode::io_error;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(body.data(), static_cast<std::streamsize>(body.size()));
+    file.write(
+        reinterpret_cast<const char*>(indexes.data()),
+        static_cast<std::streamsize>(indexes.size() * sizeof(uint32_t))
+    );
+    file.write(
+        reinterpret_cast<const char*>(meshlets.data()),
+        static_cast<std::streamsize>(meshlets.size() * sizeof(Meshlet))
+    );
+
+    return file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+//the meshlets of mesh, with their bounds found from its encoded records
+static vector<Meshlet> bounded_meshlets(const Mesh &mesh, const MeshHeader &header, const vector<char> &body){
+
+    vector<Meshlet> meshlets { mesh.meshlets };
+
+    for(Meshlet &m : meshlets)
+        meshlet_bounds(m, header, body.data(), mesh.indexes);
+
+    return meshlets;
+}
+
+ErrorCode write_binary_mesh(const string &fn, const Mesh &mesh, bool single_precision){
+
+    MeshHeader header { make_header(mesh, single_precision ? MESH_FLAG_SINGLE_PRECISION : 0) };
+
+    /**
+     * Records are encoded into a single buffer first
+     * so that the whole body goes out in one write
+     */
+    vector<char> body(mesh.vertexes.size() * record_size(header.attributes, header.flags));
+
+    if(single_precision)
+        encode_records<float>(body.data(), mesh, header.attributes);
+    else
+        encode_records<double>(body.data(), mesh, header.attributes);
+
+    extend_sphere(header, body.data(), mesh.vertexes.size());
+
+    return write_mesh_file(fn, header, body, mesh.indexes, bounded_meshlets(mesh, header, body));
+}
+
+//normal_bits is the size of each of the two octahedral components, either 8 or 16
+ErrorCode write_quantized_mesh(const string &fn, const Mesh &mesh, unsigned normal_bits){
+
+    MeshHeader header {
+        make_header(mesh, MESH_FLAG_QUANTIZED | (normal_bits == 8 ? MESH_FLAG_NORMALS_8BIT : 0))
+    };
+
+    vector<char> body(mesh.vertexes.size() * record_size(header.attributes, header.flags));
+    encode_quantized_records(body.data(), mesh, header);
+
+    extend_sphere(header, body.data(), mesh.vertexes.size());
+
+    return write_mesh_file(fn, header, body, mesh.indexes, bounded_meshlets(mesh, header, body));
+}
+
+
+
+/** BinaryMeshWriter **/
+
+//the bytes of a plain value, as they are written to a file
+template<typename T>
+static vector<char> to_bytes(const T *values, size_t count){
+
+    vector<char> bytes(count * sizeof(T));
+    std::memcpy(bytes.data(), values, bytes.size());
+
+    return bytes;
+}
+
+BinaryMeshWriter::BinaryMeshWriter(const string &fn, uint32_t flags, size_t max_queued) :
+    fn(fn), sink(OutputSink::DEFAULT_BUFFER_SIZE, max_queued), file(0), index_file(0),
+    header(empty_header(0, flags)), meshlets(), bounds()
+{
+    this->file = this->sink.open(fn, std::ios::out | std::ios::trunc | std::ios::binary);
+
+    //the header is rewritten with the final counts once done
+    this->sink.submit(this->file, to_bytes(&this->header, 1), sizeof(this->header));
+}
+
+BinaryMeshWriter::~BinaryMeshWriter(){
+    if(this->header.index_count > 0 && this->sink.is_open(this->index_file)){
+        this->sink.close(this->index_file);
+        std::remove(this->index_file_name().c_str());
+    }
+}
+
+string BinaryMeshWriter::index_file_name() const {
+    return this->fn + ".indexes";
+}
+
+bool BinaryMeshWriter::is_open() const {
+    return this->sink.is_open(this->file);
+}
+
+void BinaryMeshWriter::include_bounds(const Mesh &piece){
+
+    if(this->header.attributes == 0)
+        this->header.attributes = mesh_attributes(piece);
+
+    extend_bounds(this->header, this->bounds, piece);
+}
+
+ErrorCode BinaryMeshWriter::write(const Mesh &piece){
+
+    //every piece must have the same attributes as the first one, which set the record layout
+    if(this->header.attributes == 0)
+        this->header.attributes = mesh_attributes(piece);
+
+    else if(mesh_attributes(piece) != this->header.attributes && piece.vertexes.size() > 0)
+        return ErrorCode::invalid_argument;
+
+    //a file is either indexed throughout or not at all
+    if((this->header.index_count > 0 && !piece.is_indexed()) ||
+       (this->header.vertex_count > 0 && this->header.index_count == 0 && piece.is_indexed())
+    )
+        return ErrorCode::invalid_argument;
+
+    const uint64_t first_index { this->header.vertex_count };
+    const uint64_t first_meshlet_index { piece.is_indexed() ? this->header.index_count : first_index };
+
+    //indexes and meshlet ranges are 32 bit offsets into the whole file, which mustn't wrap around
+    static constexpr uint64_t MAX_OFFSETS { uint64_t{UINT32_MAX} + 1 };
+
+    const size_t meshlet_span { piece.is_indexed() ? piece.indexes.size() : piece.vertexes.size() };
+
+    if((piece.is_indexed() && first_index + piece.vertexes.size() > MAX_OFFSETS) ||
+       (!piece.meshlets.empty() && first_meshlet_index + meshlet_span > MAX_OFFSETS)
+    )
+        return ErrorCode::index_overflow;
+
+    if(this->header.flags & MESH_FLAG_QUANTIZED){
+        if(this->bounds.empty)
+            return ErrorCode::invalid_argument;
+    }
+    else
+        this->include_bounds(piece);
+
+    vector<char> body(piece.vertexes.size() * record_size(this->header.attributes, this->header.flags));
+
+    if(this->header.flags & MESH_FLAG_QUANTIZED)
+        encode_quantized_records(body.data(), piece, this->header);
+    else if(this->header.flags & MESH_FLAG_SINGLE_PRECISION)
+        encode_records<float>(body.data(), piece, this->header.attributes);
+    else
+        encode_records<double>(body.data(), piece, this->header.attributes);
+
+    for(Meshlet m : bounded_meshlets(piece, this->header, body)){
+        m.first_index += static_cast<uint32_t>(first_meshlet_index);
+        this->meshlets.push_back(m);
+    }
+
+    //written while the next piece is being made
+    const size_t body_size { body.size() };
+    this->sink.submit(this->file, std::move(body), body_size);
+
+    this->header.vertex_count += piece.vertexes.size();
+
+    if(piece.is_indexed()){
+
+        //indexes go after every record, so they are set aside until then
+        if(this->header.index_count == 0){
+
+            this->index_file = this->sink.open(
+                this->index_file_name(),
+                std::ios::out | std::ios::trunc | std::ios::binary
+            );
+
+            if(!this->sink.is_open(this->index_file))
+                return ErrorCode::io_error;
+        }
+
+        vector<char> indexes(piece.indexes.size() * sizeof(uint32_t));
+        char *dst { indexes.data() };
+
+        for(uint32_t i : piece.indexes){
+            const uint32_t index { i + static_cast<uint32_t>(first_index) };
+            std::memcpy(dst, &index, sizeof(index));
+            dst += sizeof(index);
+        }
+
+        const size_t indexes_size { indexes.size() };
+        this->sink.submit(this->index_file, std::move(indexes), indexes_size);
+
+        this->header.index_count += piece.indexes.size();
+    }
+
+    return ErrorCode::success;
+}
+
+ErrorCode BinaryMeshWriter::close(){
+
+    if(this->header.attributes == 0)
+        this->header.attributes = MESH_ATTR_POSITION;
+
+    if(this->header.index_count > 0){
+
+        const bool indexes_written { this->sink.close(this->index_file) };
+
+        std::ifstream set_aside {};
+        set_aside.open(this->index_file_name(), std::ios::in | std::ios::binary);
+
+        //read into the sink's own buffers, so that reading and writing overlap
+        while(indexes_written && set_aside){
+
+            vector<char> buffer { this->sink.acquire() };
+            set_aside.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+            const size_t read { static_cast<size_t>(set_aside.gcount()) };
+            this->sink.submit(this->file, std::move(buffer), read);
+        }
+
+        const bool indexes_read { indexes_written && set_aside.eof() };
+
+        set_aside.close();
+        std::remove(this->index_file_name().c_str());
+
+        if(!indexes_read)
+            return ErrorCode::io_error;
+    }
+
+    this->sink.submit(
+        this->file,
+        to_bytes(this->meshlets.data(), this->meshlets.size()),
+        this->meshlets.size() * sizeof(Meshlet)
+    );
+    this->header.meshlet_count = this->meshlets.size();
+
+    if(!this->sink.close(this->file))
+        return ErrorCode::io_error;
+
+    std::fstream file {};
+    file.open(this->fn, std::ios::in | std::ios::out | std::ios::binary);
+
+    //the sphere is centred on the final box, so it takes another pass over the records written
+    {
+        file.seekg(static_cast<std::streamoff>(sizeof(this->header)));
+
+        const size_t rec_size { record_size(this->header.attributes, this->header.flags) };
+        vector<char> buffer(rec_size * ((1 << 20) / rec_size + 1));
+
+        for(uint64_t left { this->header.vertex_count }; left > 0 && file; ){
+
+            const size_t count { static_cast<size_t>(std::min<uint64_t>(left, buffer.size() / rec_size)) };
+
+            file.read(buffer.data(), static_cast<std::streamsize>(count * rec_size));
+            extend_sphere(this->header, buffer.data(), count);
+
+            left -= count;
+        }
+
+        if(!file)
+            return ErrorCode::io_error;
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&this->header), sizeof(this->header));
+    file.close();
+
+    return file ? ErrorCode::success : ErrorCode::io_error;
+}
+
+
+
+template<typename T>
+static void decode_records(const char *src, Mesh &mesh, uint64_t vertex_count, uint32_t attributes){
+
+    for(uint64_t i{}; i < vertex_count; ++i){
+
+        const double x { get<T>(src) };
+        const double y { get<T>(src) };
+        const double z { get<T>(src) };
+        mesh.vertexes.emplace_back(x, y, z);
+
+        if(attributes & MESH_ATTR_NORMAL){
+            const double nx { get<T>(src) };
+            const double ny { get<T>(src) };
+            const double nz { get<T>(src) };
+            mesh.normals.emplace_back(nx, ny, nz);
+        }
+
+        if(attributes & MESH_ATTR_TEXT_COORD){
+            const double s { get<T>(src) };
+            const double t { get<T>(src) };
+            mesh.text_coords.emplace_back(s, t);
+        }
+    }
+}
+
+//read a quantized component, stored as T
+template<typename T>
+static inline int16_t get_quantized(const char* &src){
+    return static_cast<int16_t>(get<T>(src));
+}
+
+static void decode_quantized_records(const char *src, Mesh &mesh, const MeshHeader &header){
+
+    const array<QuantizationRange, 3> pos_ranges { position_ranges(header) };
+    const array<QuantizationRange, 2> text_ranges { text_coord_ranges(header) };
+    const unsigned bits { normal_bits(header.flags) };
+
+    for(uint64_t i{}; i < header.vertex_count; ++i){
+
+        const double x { pos_ranges[0].dequantize(get_quantized<int16_t>(src)) };
+        const double y { pos_ranges[1].dequantize(get_quantized<int16_t>(src)) };
+        const double z { pos_ranges[2].dequantize(get_quantized<int16_t>(src)) };
+        mesh.vertexes.emplace_back(x, y, z);
+
+        if(header.attributes & MESH_ATTR_NORMAL){
+            const int16_t u { bits == 8 ? get_quantized<int8_t>(src) : get_quantized<int16_t>(src) };
+            const int16_t v { bits == 8 ? get_quantized<int8_t>(src) : get_quantized<int16_t>(src) };
+            mesh.normals.push_back(oct_decode(u, v, bits));
+        }
+
+        if(header.attributes & MESH_ATTR_TEXT_COORD){
+            const double s { text_ranges[0].dequantize(get_quantized<int16_t>(src)) };
+            const double t { text_ranges[1].dequantize(get_quantized<int16_t>(src)) };
+            mesh.text_coords.emplace_back(s, t);
+        }
+    }
+}
+
+/**
+ * Read a whole binary mesh file into data, checking its header
+ * and that its size matches the counts therein
+ */
+static tuple<ErrorCode, MeshHeader, vector<char>> load_mesh_file(const string &fn){
+
+    MeshHeader header {};
+    vector<char> data {};
+
+    std::ifstream file{};
+    file.open(fn, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if(!file.is_open())
+        return { ErrorCode::io_error, header, std::move(data) };
+
+    //the whole file is brought in with a single read
+    const std::streamoff file_size { file.tellg() };
+    data.resize(static_cast<size_t>(file_size));
+
+    file.seekg(0);
+    if(!file.read(data.data(), file_size))
+        return { ErrorCode::io_error, header, std::move(data) };
+
+
+
+    const size_t hdr_size { parse_header(data.data(), data.size(), header) };
+    if(hdr_size == 0)
+        return { ErrorCode::invalid_file_formatting, header, std::move(data) };
+
+    const size_t body_size { data.size() - hdr_size };
+    const size_t rec_size { record_size(header.attributes, header.flags) };
+    const size_t tail_size { header.index_count * sizeof(uint32_t) + header.meshlet_count * sizeof(Meshlet) };
+
+    if(body_size < tail_size ||
+       (body_size - tail_size) / rec_size != header.vertex_count ||
+       (body_size - tail_size) % rec_size != 0
+    )
+        return { ErrorCode::invalid_file_formatting, header, std::move(data) };
+
+    return { ErrorCode::success, header, std::move(data) };
+}
+
+//copy the indexes following the records, checking they are all in range
+static bool read_indexes(const char *src, const MeshHeader &header, vector<uint32_t> &indexes){
+
+    indexes.resize(header.index_count);
+    std::memcpy(indexes.data(), src, header.index_count * sizeof(uint32_t));
+
+    for(uint32_t i : indexes)
+        if(i >= header.vertex_count)
+            return false;
+
+    return true;
+}
+
+//copy the meshlets following the indexes, checking they cover whole triangles in range
+static bool read_meshlets(const char *src, const MeshHeader &header, vector<Meshlet> &meshlets){
+
+    meshlets.resize(header.meshlet_count);
+    std::memcpy(meshlets.data(), src, header.meshlet_count * sizeof(Meshlet));
+
+    const uint64_t count { header.index_count > 0 ? header.index_count : header.vertex_count };
+
+    for(auto const& m : meshlets)
+        if(m.first_index % 3 != 0 || m.index_count % 3 != 0 ||
+           static_cast<uint64_t>(m.first_index) + m.index_count > count)
+            return false;
+
+    return true;
+}
+
+tuple<ErrorCode, Mesh> read_binary_mesh(const string &fn){
+
+    Mesh mesh {};
+
+    auto const& [code, header, data] { load_mesh_file(fn) };
+    if(code != ErrorCode::success)
+        return { code, std::move(mesh) };
+
+    mesh.vertexes.reserve(header.vertex_count);
+    if(header.attributes & MESH_ATTR_NORMAL)
+        mesh.normals.reserve(header.vertex_count);
+    if(header.attributes & MESH_ATTR_TEXT_COORD)
+        mesh.text_coords.reserve(header.vertex_count);
+
+    const char *body { data.data() + header_size(header.version) };
+
+    if(header.flags & MESH_FLAG_QUANTIZED)
+        decode_quantized_records(body, mesh, header);
+    else if(header.flags & MESH_FLAG_SINGLE_PRECISION)
+        decode_records<float>(body, mesh, header.vertex_count, header.attributes);
+    else
+        decode_records<double>(body, mesh, header.vertex_count, header.attributes);
+
+    const char *indexes { body + header.vertex_count * record_size(header.attributes, header.flags) };
+
+    if(!read_indexes(indexes, header, mesh.indexes) ||
+       !read_meshlets(indexes + header.index_count * sizeof(uint32_t), header, mesh.meshlets)
+    )
+        return { ErrorCode::invalid_file_formatting, Mesh{} };
+
+    return { ErrorCode::success, std::move(mesh) };
+}
+
+/**
+ * Read a quantized mesh without dequantizing it
+ * Normals are decoded, as fixed function normal arrays take three components
+ */
+tuple<ErrorCode, QuantizedMesh> read_quantized_mesh(const string &fn){
+
+    QuantizedMesh qmesh {};
+
+    auto const& [code, header, data] { load_mesh_file(fn) };
+    if(code != ErrorCode::success)
+        return { code, std::move(qmesh) };
+
+    if(!(header.flags & MESH_FLAG_QUANTIZED))
+        return { ErrorCode::invalid_file_formatting, std::move(qmesh) };
+
+    const size_t vertex_count { static_cast<size_t>(header.vertex_count) };
+    const unsigned bits { normal_bits(header.flags) };
+    const size_t normal_size { bits / 8 };
+
+    qmesh.normal_bits = bits;
+    qmesh.position_ranges = position_ranges(header);
+    qmesh.text_coord_ranges = text_coord_ranges(header);
+
+    qmesh.positions.resize(4 * vertex_count);
+    if(header.attributes & MESH_ATTR_NORMAL)
+        qmesh.normals.resize(4 * vertex_count * normal_size);
+    if(header.attributes & MESH_ATTR_TEXT_COORD)
+        qmesh.text_coords.resize(2 * vertex_count);
+
+    const double normal_max { static_cast<double>((1 << (bits - 1)) - 1) };
+
+    const char *src { data.data() + header_size(header.version) };
+
+    for(size_t i{}; i < vertex_count; ++i){
+
+        for(size_t c{}; c < 3; ++c)
+            qmesh.positions[4 * i + c] = get_quantized<int16_t>(src);
+
+        if(header.attributes & MESH_ATTR_NORMAL){
+
+            const int16_t u { bits == 8 ? get_quantized<int8_t>(src) : get_quantized<int16_t>(src) };
+            const int16_t v { bits == 8 ? get_quantized<int8_t>(src) : get_quantized<int16_t>(src) };
+            const array<double, 3> n { oct_decode(u, v, bits).as_array() };
+
+            char *dst { qmesh.normals.data() + 4 * i * normal_size };
+
+            for(size_t c{}; c < 3; ++c){
+                if(bits == 8)
+                    put<int8_t>(dst, std::round(n[c] * normal_max));
+                else
+                    put<int16_t>(dst, std::round(n[c] * normal_max));
+            }
+        }
+
+        if(header.attributes & MESH_ATTR_TEXT_COORD){
+            qmesh.text_coords[2 * i] = get_quantized<int16_t>(src);
+            qmesh.text_coords[2 * i + 1] = get_quantized<int16_t>(src);
+        }
+    }
+
+    if(!read_indexes(src, header, qmesh.indexes) ||
+       !read_meshlets(src + header.index_count * sizeof(uint32_t), header, qmesh.meshlets)
+    )
+        return { ErrorCode::invalid_file_formatting, QuantizedMesh{} };
+
+    return { ErrorCode::success, std::move(qmesh) };
+}
+
+//read only the header, e.g. to find out the size of a mesh without loading it
+tuple<ErrorCode, MeshHeader> read_binary_mesh_header(const string &fn){
+
+    std::ifstream file{};
+    file.open(fn, std::ios::in | std::ios::binary);
+
+    if(!file.is_open())
+        return { ErrorCode::io_error, MeshHeader{} };
+
+    std::array<char, sizeof(MeshHeader)> data {};
+    file.read(data.data(), data.size());
+
+    MeshHeader header {};
+    if(parse_header(data.data(), static_cast<size_t>(file.gcount()), header) == 0)
+        return { ErrorCode::invalid_file_formatting, MeshHeader{} };
+
+    return { ErrorCode::success, header };
+}
+
+Bounds header_bounds(const MeshHeader &header){
+
+    Bounds bounds {};
+
+    if(header.version < 3 || header.vertex_count == 0)
+        return bounds;
+
+    bounds.min = { header.bounds_min[0], header.bounds_min[1], header.bounds_min[2] };
+    bounds.max = { header.bounds_max[0], header.bounds_max[1], header.bounds_max[2] };
+    bounds.empty = false;
+
+    if(header.version >= 4){
+        bounds.center = { header.sphere_center[0], header.sphere_center[1], header.sphere_center[2] };
+        bounds.radius = header.sphere_radius;
+    }
+    else{
+        //version 3 only has the box, so the sphere is the one around it
+        const CartPoint3d half { (bounds.max.x - bounds.min.x) / 2.0, (bounds.max.y - bounds.min.y) / 2.0, (bounds.max.z - bounds.min.z) / 2.0 };
+
+        bounds.center = { bounds.min.x + half.x, bounds.min.y + half.y, bounds.min.z + half.z };
+        bounds.radius = std::sqrt(half.x * half.x + half.y * half.y + half.z * half.z);
+    }
+
+    return bounds;
+}
@@ -0,0 +1,137 @@
+#include "output_sink.hpp"
+
+using std::string;
+using std::vector;
+
+
+
+OutputSink::OutputSink(size_t buffer_size, size_t max_queued) :
+    files(), queue(), spare(), buffer_size(buffer_size), max_queued(max_queued),
+    queued(0), writing(false), failed(false), stopping(false),
+    mutex(), work_ready(), space_ready(), thread()
+{
+    //started last, once every member it uses is constructed
+    this->thread = std::thread{ &OutputSink::run, this };
+}
+
+OutputSink::~OutputSink(){
+
+    {
+        const std::lock_guard<std::mutex> lock { this->mutex };
+        this->stopping = true;
+    }
+
+    //whatever is still queued is written before the thread stops
+    this->work_ready.notify_one();
+    this->thread.join();
+}
+
+void OutputSink::run(){
+
+    std::unique_lock<std::mutex> lock { this->mutex };
+
+    while(true){
+
+        this->work_ready.wait(lock, [this]{ return this->stopping || !this->queue.empty(); });
+
+        if(this->queue.empty())
+            return;
+
+        Write write { std::move(this->queue.front()) };
+        this->queue.pop_front();
+        this->writing = true;
+
+        //the file and the buffer are only ever touched here while queued
+        lock.unlock();
+        write.file->write(write.buffer.data(), static_cast<std::streamsize>(write.size));
+        const bool written { static_cast<bool>(*write.file) };
+        lock.lock();
+
+        this->writing = false;
+        this->queued -= write.size;
+        this->failed = this->failed || !written;
+
+        //buffers made by acquire go back to it, without holding on to more than could be queued
+        if(write.buffer.size() == this->buffer_size &&
+           this->spare.size() * this->buffer_size < this->max_queued)
+            this->spare.push_back(std::move(write.buffer));
+
+        this->space_ready.notify_all();
+    }
+}
+
+void OutputSink::wait_idle(std::unique_lock<std::mutex> &lock){
+    this->space_ready.wait(lock, [this]{ return this->queue.empty() && !this->writing; });
+}
+
+size_t OutputSink::open(const string &fn, std::ios::openmode mode){
+
+    //files are only added by the producer, and the I/O thread never walks the deque itself
+    this->files.emplace_back();
+    this->files.back().open(fn, mode | std::ios::out);
+
+    return this->files.size() - 1;
+}
+
+bool OutputSink::is_open(size_t file) const {
+    return this->files[file].is_open();
+}
+
+vector<char> OutputSink::acquire(){
+
+    {
+        const std::lock_guard<std::mutex> lock { this->mutex };
+
+        if(this->spare.size() > 0){
+            vector<char> buffer { std::move(this->spare.back()) };
+            this->spare.pop_back();
+            return buffer;
+        }
+    }
+
+    return vector<char>(this->buffer_size);
+}
+
+void OutputSink::submit(size_t file, vector<char> &&buffer, size_t size){
+
+    if(size == 0)
+        return;
+
+    std::unique_lock<std::mutex> lock { this->mutex };
+
+    this->space_ready.wait(lock, [this, size]{
+        return this->queued == 0 || this->queued + size <= this->max_queued;
+    });
+
+    this->queue.push_back({ &this->files[file], std::move(buffer), size });
+    this->queued += size;
+
+    lock.unlock();
+    this->work_ready.notify_one();
+}
+
+bool OutputSink::flush(){
+
+    std::unique_lock<std::mutex> lock { this->mutex };
+    this->wait_idle(lock);
+
+    //nothing is queued, so the files are the producer's alone
+    for(auto &f : this->files)
+        if(f.is_open())
+            f.flush();
+
+    for(auto const& f : this->files)
+        this->failed = this->failed || (f.is_open() && !f);
+
+    return !this->failed;
+}
+
+bool OutputSink::close(size_t file){
+
+    const bool flushed { this->flush() };
+
+    const std::lock_guard<std::mutex> lock { this->mutex };
+    this->files[file].close();
+
+    return flushed && static_cast<bool>(this->files[file]);
+}
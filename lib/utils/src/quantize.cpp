@@ -0,0 +1,103 @@
+#include "quantize.hpp"
+
+#include <algorithm>
+
+using std::array;
+
+
+
+/** QuantizationRange **/
+
+QuantizationRange::QuantizationRange() :
+    offset(0.0), scale(1.0) {}
+
+QuantizationRange::QuantizationRange(double min, double max) :
+    offset((min + max) / 2.0),
+    scale((max - min) / 2.0 / QUANTIZED_MAX)
+{
+    //an empty range quantizes everything to 0, any scale does
+    if(!(this->scale > 0.0))
+        this->scale = 1.0;
+}
+
+int16_t QuantizationRange::quantize(double value) const {
+
+    const double q { std::round((value - this->offset) / this->scale) };
+
+    return static_cast<int16_t>(
+        std::clamp(q, -static_cast<double>(QUANTIZED_MAX), static_cast<double>(QUANTIZED_MAX))
+    );
+}
+
+double QuantizationRange::dequantize(int16_t q) const {
+    return this->offset + q * this->scale;
+}
+
+
+
+/** Octahedral encoding **/
+
+static inline double sign_not_zero(double d){
+    return d < 0.0 ? -1.0 : 1.0;
+}
+
+static inline double snorm_max(unsigned bits){
+    return static_cast<double>((1 << (bits - 1)) - 1);
+}
+
+array<int16_t, 2> oct_encode(const CartPoint3d &n, unsigned bits){
+
+    const double l1 { std::abs(n.x) + std::abs(n.y) + std::abs(n.z) };
+    if(l1 == 0.0)
+        return { 0, 0 };
+
+    double u { n.x / l1 };
+    double v { n.y / l1 };
+
+    if(n.z < 0.0){
+        const double fu { (1.0 - std::abs(v)) * sign_not_zero(u) };
+        const double fv { (1.0 - std::abs(u)) * sign_not_zero(v) };
+        u = fu;
+        v = fv;
+    }
+
+    const double max { snorm_max(bits) };
+    const CartPoint3d unit { n.normalize() };
+
+    //plain rounding may be off by up to a step, so the four neighbours are tried
+    array<int16_t, 2> best {};
+    double best_dot { -2.0 };
+
+    for(double qu : { std::floor(u * max), std::ceil(u * max) })
+        for(double qv : { std::floor(v * max), std::ceil(v * max) }){
+
+            const array<int16_t, 2> q { static_cast<int16_t>(qu), static_cast<int16_t>(qv) };
+            const CartPoint3d d { oct_decode(q[0], q[1], bits) };
+
+            const double dot { d.x * unit.x + d.y * unit.y + d.z * unit.z };
+            if(dot > best_dot){
+                best_dot = dot;
+                best = q;
+            }
+        }
+
+    return best;
+}
+
+CartPoint3d oct_decode(int16_t x, int16_t y, unsigned bits){
+
+    const double max { snorm_max(bits) };
+
+    double u { std::clamp(x / max, -1.0, 1.0) };
+    double v { std::clamp(y / max, -1.0, 1.0) };
+    const double w { 1.0 - std::abs(u) - std::abs(v) };
+
+    if(w < 0.0){
+        const double fu { (1.0 - std::abs(v)) * sign_not_zero(u) };
+        const double fv { (1.0 - std::abs(u)) * sign_not_zero(v) };
+        u = fu;
+        v = fv;
+    }
+
+    return CartPoint3d{ u, v, w }.normalize();
+}
@@ -0,0 +1,239 @@
+#include "text_reader.hpp"
+#include "filters.hpp"
+#include "mapped_file.hpp"
+#include "text_scanner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <type_traits>
+
+using std::vector;
+using std::string;
+using std::tuple;
+using std::array;
+
+
+
+//files are only split into chunks of at least this many bytes, smaller ones being parsed faster than threads start
+static constexpr size_t MIN_CHUNK_SIZE { size_t{ 8 } << 20 };
+
+//the coordinates of a point, separated by ';' and maybe whitespace, as written by operator<<
+static bool read_coordinates(TextScanner &scanner, double *coords, size_t count){
+
+    for(size_t i{}; i < count; ++i){
+
+        scanner.skip_whitespace();
+
+        if(i > 0){
+            if(!scanner.accept(';'))
+                return false;
+
+            scanner.skip_whitespace();
+        }
+
+        if(!scanner.read_double(coords[i]))
+            return false;
+    }
+
+    return true;
+}
+
+//memchr skips over whole lines at once, where counting character by character wouldn't
+static size_t count_lines(const char *first, const char *last){
+
+    size_t lines {};
+
+    while(first != last){
+
+        const void *line_break { std::memchr(first, '\n', static_cast<size_t>(last - first)) };
+        if(line_break == nullptr)
+            break;
+
+        ++lines;
+        first = static_cast<const char*>(line_break) + 1;
+    }
+
+    return lines;
+}
+
+template<typename T>
+static constexpr size_t DIMENSIONS { std::is_same<T, CartPoint3d>::value ? 3 : 2 };
+
+template<typename T>
+static bool read_point(TextScanner &scanner, T &p){
+
+    array<double, DIMENSIONS<T>> c {};
+
+    if(!read_coordinates(scanner, c.data(), c.size()))
+        return false;
+
+    if constexpr(DIMENSIONS<T> == 3)
+        p = { c[0], c[1], c[2] };
+    else
+        p = { c[0], c[1] };
+
+    return true;
+}
+
+//run task(i) for every i in [0, count), each on a thread of its own but the first, which runs on this one
+static void run_parallel(size_t count, const std::function<void(size_t)> &task){
+
+    vector<std::thread> workers {};
+
+    for(size_t i { 1 }; i < count; ++i)
+        workers.emplace_back(task, i);
+
+    if(count > 0)
+        task(0);
+
+    for(auto& w : workers)
+        w.join();
+}
+
+/**
+ * Read every point of a text file, a whole triangle at a time, stopping
+ * at the first thing which isn't a point and keeping the triangles read before it
+ */
+template<typename T>
+static void read_serial(const MappedFile &file, vector<T> &points){
+
+    //each point is written on a line of its own, so there are about as many as there are lines
+    points.reserve(count_lines(file.data(), file.end()) + 1);
+
+    TextScanner scanner { file.data(), file.end() };
+    T p1{}, p2{}, p3{};
+
+    while(read_point(scanner, p1) && read_point(scanner, p2) && read_point(scanner, p3)){
+        points.push_back(p1);
+        points.push_back(p2);
+        points.push_back(p3);
+    }
+}
+
+/**
+ * Read a well formed text file split at line breaks into chunks, parsed concurrently,
+ * each straight into its own slice of points, as counted by the ';' in it beforehand
+ * Points are thus where a serial read would put them, but points running over a line break
+ * or anything which isn't a point can't be told apart from a chunk boundary, so false is returned
+ * should any chunk not hold exactly the points counted, for the file to be read serially
+ */
+template<typename T>
+static bool read_chunks(const MappedFile &file, size_t chunk_count, vector<T> &points){
+
+    const char *data { file.data() };
+    const size_t size { file.size() };
+
+    vector<const char*> bounds(chunk_count + 1, file.end());
+    bounds[0] = data;
+
+    for(size_t i { 1 }; i < chunk_count; ++i){
+
+        const char *split { std::max(data + size * i / chunk_count, bounds[i - 1]) };
+        const void *line_break { std::memchr(split, '\n', static_cast<size_t>(file.end() - split)) };
+
+        bounds[i] = line_break != nullptr ? static_cast<const char*>(line_break) + 1 : file.end();
+    }
+
+    //each point has one ';' less than it has coordinates
+    vector<size_t> counts(chunk_count, 0);
+    vector<char> valid(chunk_count, true);      //rather than bool, so that each thread writes a byte of its own
+
+    run_parallel(chunk_count, [&](size_t i){
+
+        const size_t separators { static_cast<size_t>(std::count(bounds[i], bounds[i + 1], ';')) };
+
+        valid[i] = separators % (DIMENSIONS<T> - 1) == 0;
+        counts[i] = separators / (DIMENSIONS<T> - 1);
+    });
+
+    if(std::find(valid.begin(), valid.end(), false) != valid.end())
+        return false;
+
+    vector<size_t> offsets(chunk_count + 1, 0);
+    for(size_t i{}; i < chunk_count; ++i)
+        offsets[i + 1] = offsets[i] + counts[i];
+
+    points.resize(offsets.back());
+
+    run_parallel(chunk_count, [&](size_t i){
+
+        TextScanner scanner { bounds[i], bounds[i + 1] };
+
+        for(size_t p { offsets[i] }; p < offsets[i + 1]; ++p)
+            if(!read_point(scanner, points[p])){
+                valid[i] = false;
+                return;
+            }
+
+        scanner.skip_whitespace();
+        valid[i] = scanner.at_end();
+    });
+
+    if(std::find(valid.begin(), valid.end(), false) != valid.end())
+        return false;
+
+    //only whole triangles are kept
+    points.resize(points.size() - points.size() % 3);
+
+    return true;
+}
+
+template<typename T>
+static tuple<ErrorCode, vector<T>> file_reader(const string& fn, unsigned threads){
+
+    static_assert(
+        std::is_same<T, CartPoint3d>::value ||
+        std::is_same<T, CartPoint2d>::value
+    );
+
+    vector<T> points {};
+
+    const MappedFile file { fn };
+
+    if(!file.is_open())
+        return {
+            ErrorCode::io_error,
+            std::move(points)
+        };
+
+    //hardware_concurrency may be 0 if it isn't computable
+    const size_t max_threads { threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u) };
+    const size_t chunk_count { std::min(max_threads, file.size() / MIN_CHUNK_SIZE) };
+
+    if(chunk_count < 2 || !read_chunks(file, chunk_count, points)){
+        points.clear();
+        read_serial(file, points);
+    }
+
+    return {
+        ErrorCode::success,
+        std::move(points)
+    };
+}
+
+tuple<ErrorCode, ErrorCode, ErrorCode, Mesh> read_text_mesh(const string &fn, unsigned threads){
+
+    auto&& [vcode, vertexes] { file_reader<CartPoint3d>(fn, threads) };
+    auto&& [ncode, normals] { file_reader<CartPoint3d>(to_norm_extension(fn), threads) };
+    auto&& [tcode, text_coords] { file_reader<CartPoint2d>(to_text_extension(fn), threads) };
+
+    Mesh mesh {};
+    mesh.vertexes = std::move(vertexes);
+    mesh.normals = std::move(normals);
+    mesh.text_coords = std::move(text_coords);
+
+    return { vcode, ncode, tcode, std::move(mesh) };
+}
+
+tuple<ErrorCode, Mesh> read_mesh(const string &fn){
+
+    if(is_binary_mesh(fn))
+        return read_binary_mesh(fn);
+
+    auto&& [vcode, ncode, tcode, mesh] { read_text_mesh(fn) };
+
+    return { vcode, std::move(mesh) };
+}
@@ -0,0 +1,60 @@
+#include "text_scanner.hpp"
+
+#include <charconv>
+#include <cmath>
+
+
+
+TextScanner::TextScanner(const char *begin, const char *end) :
+    pos(begin), last(end), line_start(begin), line_num(1) {}
+
+bool TextScanner::read_uint(uint64_t &value, uint64_t max){
+
+    const char *p { this->pos };
+
+    if(p != this->last && *p == '+')
+        ++p;
+
+    const char *digits { p };
+    uint64_t result {};
+
+    for(; p != this->last && *p >= '0' && *p <= '9'; ++p){
+
+        const uint64_t digit { static_cast<uint64_t>(*p - '0') };
+
+        if(result > (max - digit) / 10)
+            return false;
+
+        result = result * 10 + digit;
+    }
+
+    if(p == digits)
+        return false;
+
+    value = result;
+    this->pos = p;
+
+    return true;
+}
+
+bool TextScanner::read_double(double &value){
+
+    //from_chars takes no '+', and would take "inf" and "nan", which istream doesn't
+    const bool plus { !this->at_end() && *this->pos == '+' };
+    const char *first { plus ? this->pos + 1 : this->pos };
+    const char *digits { !plus && first != this->last && *first == '-' ? first + 1 : first };
+
+    if(digits == this->last || !((*digits >= '0' && *digits <= '9') || *digits == '.'))
+        return false;
+
+    double result {};
+    const std::from_chars_result parsed { std::from_chars(first, this->last, result) };
+
+    if(parsed.ec != std::errc{} || !std::isfinite(result))
+        return false;
+
+    value = result;
+    this->pos = parsed.ptr;
+
+    return true;
+}
@@ -0,0 +1,88 @@
+#include "text_writer.hpp"
+
+#include <charconv>
+
+using std::string;
+
+
+
+//longest shortest round-trip double, e.g. -2.2250738585072014e-308
+static constexpr size_t MAX_DOUBLE_CHARS { 24 };
+
+//three numbers, their separators and the newline
+static constexpr size_t MAX_LINE_CHARS { 3 * MAX_DOUBLE_CHARS + 5 };
+
+
+
+TextWriter::TextWriter(OutputSink &sink, const string &fn) :
+    sink(sink), file(sink.open(fn)), buffer(sink.acquire()), used(0)
+{}
+
+TextWriter::~TextWriter(){
+
+    //the sink writes what is left on its own, there is no need for another buffer
+    if(this->used > 0)
+        this->sink.submit(this->file, std::move(this->buffer), this->used);
+}
+
+bool TextWriter::is_open() const {
+    return this->sink.is_open(this->file);
+}
+
+void TextWriter::submit(){
+
+    if(this->used > 0){
+        this->sink.submit(this->file, std::move(this->buffer), this->used);
+        this->buffer = this->sink.acquire();
+        this->used = 0;
+    }
+}
+
+bool TextWriter::flush(){
+    this->submit();
+    return this->sink.flush();
+}
+
+void TextWriter::reserve(size_t size){
+    if(this->buffer.size() - this->used < size)
+        this->submit();
+}
+
+void TextWriter::put(double d){
+
+    char *begin { this->buffer.data() + this->used };
+
+    //reserve guarantees room, so this never fails
+    auto const [end, _] { std::to_chars(begin, begin + MAX_DOUBLE_CHARS, d) };
+
+    this->used += static_cast<size_t>(end - begin);
+}
+
+TextWriter& TextWriter::operator<<(const CartPoint3d &p){
+
+    this->reserve(MAX_LINE_CHARS);
+
+    this->put(p.x);
+    this->buffer[this->used++] = ';';
+    this->buffer[this->used++] = ' ';
+    this->put(p.y);
+    this->buffer[this->used++] = ';';
+    this->buffer[this->used++] = ' ';
+    this->put(p.z);
+    this->buffer[this->used++] = '\n';
+
+    return *this;
+}
+
+TextWriter& TextWriter::operator<<(const CartPoint2d &p){
+
+    this->reserve(MAX_LINE_CHARS);
+
+    this->put(p.x);
+    this->buffer[this->used++] = ';';
+    this->buffer[this->used++] = ' ';
+    this->put(p.y);
+    this->buffer[this->used++] = '\n';
+
+    return *this;
+}
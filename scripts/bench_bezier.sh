@@ -0,0 +1,47 @@
+#!/bin/bash
+
+# Used to benchmark the tesselation throughput
+# of the bezier primitive for increasing tesselation levels
+# Per level timings are only printed if bin/generator
+# was built with -DBENCH (see the root makefile)
+
+DIR=$(dirname $BASH_SOURCE)
+
+GEN=$DIR/../bin/generator
+RESOURCES=$DIR/../resources
+
+main(){
+
+    if [[ -f $GEN ]]
+    then
+        local code=0
+
+        for (( i=25; i <= 400; i *= 2 ));
+        do
+            echo "tesselation level: $i"
+            $GEN --binary bezier $RESOURCES/teapot.patch $i $RESOURCES/bezier_bench.3d
+            code=$?
+
+            if [[ $code -ne 0 ]]
+            then
+                break
+            fi
+        done
+
+        #along with the cache's hash, and the .norm, .text and .bounds files should it be run without --binary
+        rm -f $RESOURCES/bezier_bench.{3d,norm,text,hash,bounds}
+
+        if [[ $code -ne 0 ]]
+        then
+            echo "generator exited with error code"
+            return 1
+        fi
+
+        return 0
+    else
+        echo "error: bin/generator not found" 1>&2
+        return 1
+    fi
+}
+
+main
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Used to benchmark the parsing of .patch files
+# A synthetic file with millions of patches is generated
+# and tesselated at level 1, so that parsing dominates
+# Parse timings are only printed if bin/generator
+# was built with -DBENCH (see the root makefile)
+
+DIR=$(dirname $BASH_SOURCE)
+
+GEN=$DIR/../bin/generator
+RESOURCES=$DIR/../resources
+
+PATCHES=${1:-2000000}
+CTRL_POINTS=100000
+
+main(){
+
+    if [[ -f $GEN ]]
+    then
+        awk -v patches=$PATCHES -v points=$CTRL_POINTS 'BEGIN {
+            srand(1)
+            print patches
+            for(p = 0; p < patches; ++p){
+                line = int(rand() * points)
+                for(i = 1; i < 16; ++i)
+                    line = line ", " int(rand() * points)
+                print line
+            }
+            print points
+            for(c = 0; c < points; ++c)
+                printf "%.6f, %.6f, %.6f\n", rand() * 4 - 2, rand() * 4 - 2, rand() * 4 - 2
+        }' > $RESOURCES/patch_bench.patch
+
+        echo "$PATCHES patches, $(du -h $RESOURCES/patch_bench.patch | cut -f1)"
+        time $GEN --binary bezier $RESOURCES/patch_bench.patch 1 $RESOURCES/patch_bench.3d
+        local code=$?
+
+        rm -f $RESOURCES/patch_bench.patch $RESOURCES/patch_bench.{3d,hash}
+
+        if [[ $code -ne 0 ]]
+        then
+            echo "generator exited with error code"
+            return 1
+        fi
+
+        return 0
+    else
+        echo "error: bin/generator not found" 1>&2
+        return 1
+    fi
+}
+
+main
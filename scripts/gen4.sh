@@ -16,6 +16,8 @@ main(){
         $GEN sphere 1 32 32 $RESOURCES/sphere_nt2.3d
         $GEN bezier $RESOURCES/teapot.patch 10 $RESOURCES/bezier_nt.3d
         $GEN torus 2 1 20 20 $RESOURCES/torus_nt.3d
+        $GEN --quantize 16 plane 2 3 $RESOURCES/plane_q.3d
+        $GEN --quantize 16 torus 2 1 20 20 $RESOURCES/torus_q.3d
         return 0
     else
         echo "error: bin/generator not found" 1>&2